@@ -4,6 +4,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <arch/page.hpp>
+
 #include <kernel/ioport.hpp>
 #include <kernel/console.hpp>
 
@@ -22,21 +24,44 @@
 /** CGA mode memory map start address */
 #define VGA_CGA_MEMORY 0xB8000
 
-void kernel::Console::update_cursor(uint16_t column, uint16_t row)
+/** Size of CGA mode memory map in bytes */
+#define VGA_CGA_MEMORY_SIZE 0x8000
+
+/** CRT controller index and data registers */
+#define VGA_CRTC_INDEX 0x3D4
+#define VGA_CRTC_DATA 0x3D5
+
+/** CRT controller register indices */
+#define VGA_CRTC_START_HI 0x0C
+#define VGA_CRTC_START_LO 0x0D
+#define VGA_CRTC_CURSOR_HI 0x0E
+#define VGA_CRTC_CURSOR_LO 0x0F
+
+void kernel::Console::update_cursor(uint16_t location)
 {
-    // get location
-    uint16_t cursorLocation = row * VGA_WIDTH + column;
+    kernel::outb(VGA_CRTC_CURSOR_HI, VGA_CRTC_INDEX);
+    kernel::outb(location >> 8, VGA_CRTC_DATA); // Send the high byte.
+    kernel::outb(VGA_CRTC_CURSOR_LO, VGA_CRTC_INDEX);
+    kernel::outb(location, VGA_CRTC_DATA); // Send the low byte.
+}
 
-    kernel::outb(14, 0x3D4);
-    kernel::outb(cursorLocation >> 8, 0x3D5); // Send the high byte.
-    kernel::outb(15, 0x3D4);
-    kernel::outb(cursorLocation, 0x3D5); // Send the low byte.
+void kernel::Console::update_origin(uint16_t location)
+{
+    kernel::outb(VGA_CRTC_START_HI, VGA_CRTC_INDEX);
+    kernel::outb(location >> 8, VGA_CRTC_DATA); // Send the high byte.
+    kernel::outb(VGA_CRTC_START_LO, VGA_CRTC_INDEX);
+    kernel::outb(location, VGA_CRTC_DATA); // Send the low byte.
 }
 
 void kernel::Console::initialize(enum VGAColor fg_color, enum VGAColor bg_color)
 {
     color = uint8_t(fg_color) | uint8_t(bg_color) << 4;
-    buffer = (uint16_t *)VGA_CGA_MEMORY;
+    buffer = (uint16_t *)phys_to_virt(VGA_CGA_MEMORY);
+    buffer_size = VGA_CGA_MEMORY_SIZE / sizeof(uint16_t);
+
+    // Force programming of screen start and cursor on first flush
+    hw_origin = hw_cursor = (size_t)-1;
+
     set_fg_color(fg_color);
     set_bg_color(bg_color);
     clrscr();
@@ -4,13 +4,25 @@ MEMINFO  equ  1 << 1            ; provide memory map
 FLAGS    equ  MBALIGN | MEMINFO ; this is the Multiboot 'flag' field
 MAGIC    equ  0x1BADB002        ; 'magic number' lets bootloader find the header
 CHECKSUM equ -(MAGIC + FLAGS)   ; checksum of above, to prove we are multiboot
+
+; Declare constants for the boot page tables. The kernel is linked at
+; KERNEL_VIRTUAL_BASE but loaded at physical 1 MiB. Until paging is enabled
+; every kernel symbol has to be translated to its physical address.
+KERNEL_VIRTUAL_BASE equ 0xC0000000                ; kernel direct map base, see arch/page.hpp
+KERNEL_PDE          equ KERNEL_VIRTUAL_BASE >> 22 ; page directory entry of the direct map
+BOOT_PAGE_TABLES    equ 4                         ; page tables mapping the first 16 MiB
+RECURSIVE_PDE       equ 1023                      ; page directory entry mapping the page tables
+PAGE_PRESENT        equ 1 << 0
+PAGE_WRITE          equ 1 << 1
+CR0_WP              equ 1 << 16                   ; honor read-only pages in the kernel
+CR0_PG              equ 1 << 31                   ; enable paging
  
 ; Declare a multiboot header that marks the program as a kernel. These are magic
 ; values that are documented in the multiboot standard. The bootloader will
 ; search for this signature in the first 8 KiB of the kernel file, aligned at a
 ; 32-bit boundary. The signature is in its own section so the header can be
 ; forced to be within the first 8 KiB of the kernel file.
-section .multiboot
+section .multiboot.data
 align 4
 	dd MAGIC
 	dd FLAGS
@@ -31,12 +43,24 @@ align 16
 stack_bottom:
 resb 16384 ; 16 KiB
 stack_top:
+
+; The boot page directory and page tables map the first 16 MiB of physical
+; memory twice: at address zero, so the boot code keeps running when paging
+; is turned on, and at KERNEL_VIRTUAL_BASE where the kernel is linked. The
+; identity mapping is dropped once the kernel page tables are set up. The
+; bootloader zeroes the section, so all other entries are not present.
+align 4096
+boot_page_directory:
+resb 4096
+boot_page_tables:
+resb 4096 * BOOT_PAGE_TABLES
  
 ; The linker script specifies _start as the entry point to the kernel and the
 ; bootloader will jump to this position once the kernel has been loaded. It
 ; doesn't make sense to return from this function as the bootloader is gone.
-; Declare _start as a function symbol with the given symbol size.
-section .text
+; Declare _start as a function symbol with the given symbol size. It is
+; placed in its own section linked at its load address, as paging is off.
+section .multiboot.text
 global _start:function (_start.end - _start)
 _start:
 	; The bootloader has loaded us into 32-bit protected mode on a x86
@@ -49,7 +73,47 @@ _start:
 	; safeguards, no debugging mechanisms, only what the kernel provides
 	; itself. It has absolute and complete power over the
 	; machine.
- 
+
+	; Fill the boot page tables with the first 16 MiB of physical memory.
+	; The ebx register holding the multiboot information is left alone.
+	cld
+	mov edi, boot_page_tables - KERNEL_VIRTUAL_BASE
+	mov eax, PAGE_PRESENT | PAGE_WRITE
+	mov ecx, 1024 * BOOT_PAGE_TABLES
+.fill_table:
+	stosd
+	add eax, 4096
+	loop .fill_table
+
+	; Point the identity and the higher half directory entries at them
+	mov edi, boot_page_directory - KERNEL_VIRTUAL_BASE
+	mov eax, boot_page_tables - KERNEL_VIRTUAL_BASE + (PAGE_PRESENT | PAGE_WRITE)
+	xor ecx, ecx
+.fill_directory:
+	mov [edi + ecx * 4], eax
+	mov [edi + KERNEL_PDE * 4 + ecx * 4], eax
+	add eax, 4096
+	inc ecx
+	cmp ecx, BOOT_PAGE_TABLES
+	jb .fill_directory
+
+	; The last directory entry maps the page tables themselves
+	lea eax, [edi + (PAGE_PRESENT | PAGE_WRITE)]
+	mov [edi + RECURSIVE_PDE * 4], eax
+
+	; Enable paging
+	mov cr3, edi
+	mov eax, cr0
+	or eax, CR0_PG | CR0_WP
+	mov cr0, eax
+
+	; Jump to the higher half through an absolute address
+	lea ecx, [.higher_half]
+	jmp ecx
+.end:
+
+section .text
+_start.higher_half:
 	; To set up a stack, we set the esp register to point to the top of our
 	; stack (as it grows downwards on x86 systems). This is necessarily done
 	; in assembly as languages such as C cannot function without a stack.
@@ -60,15 +124,15 @@ _start:
 	; environment where crucial features are offline. Note that the
 	; processor is not fully initialized yet: Features such as floating
 	; point instructions and instruction set extensions are not initialized
-	; yet. The GDT should be loaded here. Paging should be enabled here.
+	; yet. The GDT should be loaded here. Paging has been enabled above.
 	; C++ features such as global constructors and exceptions will require
 	; runtime support to work as well.
 	extern _init	; Global constructors
 	call _init
 
 	; Push the multiboot information for the kernel entrypoint. As per the 
-	; multiboot specification the address to this information is stored in 
-	; the ebx register.
+	; multiboot specification the physical address to this information is
+	; stored in the ebx register.
 	push dword ebx
 
 	; Disable interupts in case they are enabled
@@ -107,5 +171,4 @@ _start:
 	;    non-maskable interrupt occurring or due to system management mode.
 	cli
 .hang:	hlt
-	jmp .hang
-.end:
\ No newline at end of file
+	jmp .hang
\ No newline at end of file
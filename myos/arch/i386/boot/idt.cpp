@@ -83,73 +83,15 @@ static struct __attribute__((packed)) IDTRegister
 static I386::IDT::Descriptor idt[IDT_MAX_DESCRIPTORS]; /**< Array of descriptors. */
 
 /**
- * Interrupt Service Request (ISR) entry and exit stub template. 
+ * Table of Interrupt Service Request (ISR) entry stub addresses indexed by
+ * vector number.
  * 
- * The template sets up the stack frame for an ISR. This is needed since 
- * the standard C++ stack frame setup for functions is inconsistent with 
- * that required for interrupts due to the difference in the ret and iret
- * assembly instructions. After setting up the stack frame, the ISR stub 
+ * The stubs are defined in `entry.asm`. Each stub pushes the vector number
+ * and jumps to a common trampoline which sets up the ISR stack frame and 
  * redirects execution to the common interrupt handler entry point 
  * `kernel::IVT::isr_entry`.
- * 
- * @param n interrupt number associated with ISR
- * @param error_code boolean indcating interrupt is passed with error code. 
- *  If not a bogus error code is passed to ISR handler stack frame.
  */
-template <uint32_t num, bool error_code>
-static void isr_stub(void)
-{
-    asm volatile("cli\n\t"
-                 // Check if the sub is for exception interrupt
-                 ".if %c0\n\t"
-                 // Do nothing as the error code is pushed by processor.
-                 ".else\n\t"
-                 // Else push bogus error code
-                 "push $0\n\t"
-                 // End of if marco
-                 ".endif\n\t"
-                 // Pushes edi,esi,ebp,esp,ebx,edx,ecx,eax
-                 "pusha\n\t"
-                 // Get the original data segment descriptor
-                 "mov %%ds, %%ax\n\t"
-                 // And save it into the stack
-                 "push %%eax\n\t"
-                 // Load the kernel data segment descriptor
-                 "mov %2, %%ax\n\t"
-                 "mov %%ax, %%ds\n\t"
-                 "mov %%ax, %%es\n\t"
-                 "mov %%ax, %%fs\n\t"
-                 "mov %%ax, %%gs\n\t"
-                 // Push interrupt number to stack frame
-                 "push %1\n\t"
-                 // Push a pointer to an stack frame used by the ISR handler common entry point
-                 "push %%esp\n\t"
-                 // Call the ISR handler common entry point
-                 "mov %3, %%eax\n\t"
-                 "call *%%eax\n\t"
-                 // Unwind the stack by reducing stack size by the 8 bytes
-                 // This is done to unload the stack frame pointer and isr number
-                 "add  $8, %%esp\n\t"
-                 // Reload the original data segment descriptor
-                 "pop  %%eax\n\t"
-                 "mov  %%ax, %%ds\n\t"
-                 "mov  %%ax, %%es\n\t"
-                 "mov  %%ax, %%fs\n\t"
-                 "mov  %%ax, %%gs\n\t"
-                 // Pop edi,esi,ebp,esp,ebx,edx,ecx,eax
-                 "popa\n\t"
-                 // Unload the pushed error code
-                 "add  $4, %%esp\n\t"
-                 // Enable interrupts
-                 "sti\n\t"
-                 // pops 5 things at once: cs,eip,eflags,ss,esp
-                 "iret\n\t"
-                 :
-                 : "i"(error_code),
-                   "i"(num),
-                   "i"(I386::GDT::KERNEL_DATA_SEGMENT),
-                   "i"(kernel::IVT::isr_entry));
-}
+extern "C" const uint32_t isr_stub_table[IDT_MAX_DESCRIPTORS];
 
 void I386::IDT::set_descriptor(uint32_t idx, I386::IDT::Descriptor *desc)
 {
@@ -179,75 +121,30 @@ void I386::IDT::flush()
 
 void I386::IDT::setup()
 {
-#define SETUP_IRQ(num, error_code)                          \
-    idt[num].set_isr((uint32_t)&isr_stub<num, error_code>); \
-    idt[num].set_selector(I386::GDT::KERNEL_CODE_SEGMENT);  \
+#define SETUP_IRQ(num)                                     \
+    idt[num].set_isr(isr_stub_table[num]);                 \
+    idt[num].set_selector(I386::GDT::KERNEL_CODE_SEGMENT); \
     idt[num].set_flags(IDT_DESC_FLAG_PRESENT | IDT_DESC_FLAG_INT_BIT32);
 
     /*
     * Setup interrupts for Exceptions and Faults
     */
 
-    SETUP_IRQ(0, false);
-    SETUP_IRQ(1, false);
-    SETUP_IRQ(2, false);
-    SETUP_IRQ(3, false);
-    SETUP_IRQ(4, false);
-    SETUP_IRQ(5, false);
-    SETUP_IRQ(6, false);
-    SETUP_IRQ(7, false);
-    SETUP_IRQ(8, true);
-    SETUP_IRQ(9, false);
-    SETUP_IRQ(10, true);
-    SETUP_IRQ(11, true);
-    SETUP_IRQ(12, true);
-    SETUP_IRQ(13, true);
-    SETUP_IRQ(14, true);
-    SETUP_IRQ(15, false);
-    SETUP_IRQ(16, false);
-    SETUP_IRQ(17, false);
-    SETUP_IRQ(18, false);
-    SETUP_IRQ(19, false);
-    SETUP_IRQ(20, false);
-    SETUP_IRQ(21, true);
-    SETUP_IRQ(21, true);
-    SETUP_IRQ(22, true);
-    SETUP_IRQ(23, true);
-    SETUP_IRQ(24, true);
-    SETUP_IRQ(25, false);
-    SETUP_IRQ(26, false);
-    SETUP_IRQ(27, false);
-    SETUP_IRQ(28, false);
-    SETUP_IRQ(29, false);
-    SETUP_IRQ(30, false);
-    SETUP_IRQ(31, false);
+    for (uint32_t num = 0; num < ISR_IRQ0; num++)
+    {
+        SETUP_IRQ(num);
+    }
 
     /**
-     * Setup default handlers for rest of the interrupts
+     * Setup default handlers for rest of the interrupts. These include
+     * hardware interrupts routed by the PIC or IOAPIC, local APIC 
+     * interrupts and the software interrupt used by syscalls.
      */
 
-    SETUP_IRQ(32, false);
-    SETUP_IRQ(33, false);
-    SETUP_IRQ(34, false);
-    SETUP_IRQ(35, false);
-    SETUP_IRQ(36, false);
-    SETUP_IRQ(37, false);
-    SETUP_IRQ(38, false);
-    SETUP_IRQ(39, false);
-    SETUP_IRQ(40, false);
-    SETUP_IRQ(41, false);
-    SETUP_IRQ(42, false);
-    SETUP_IRQ(43, false);
-    SETUP_IRQ(44, false);
-    SETUP_IRQ(45, false);
-    SETUP_IRQ(46, false);
-    SETUP_IRQ(47, false);
-
-    /** 
-     * Software interrupt (used by syscalls) 
-     */
-
-    SETUP_IRQ(ISR_SYSCALL, false); // Commonly used IRQ number used for syscalls.
+    for (uint32_t num = ISR_IRQ0; num < IDT_MAX_DESCRIPTORS; num++)
+    {
+        SETUP_IRQ(num);
+    }
 
 #undef SETUP_IRQ
 
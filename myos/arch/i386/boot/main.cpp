@@ -1,5 +1,7 @@
 #include <boot/multiboot.hpp>
 
+#include <arch/page.hpp>
+
 #include <kernel/console.hpp>
 #include <kernel/ioport.hpp>
 
@@ -22,10 +24,15 @@ extern "C" void start_kernel(boot::MultibootInfo *multiboot_info) __attribute__(
  * Entry point for kernel boot sequence. All real and/or protected mode setup 
  * required for the correct functioning of the kernel is pereformed here.
  * 
- * @param multiboot_info multiboot information provided by bootloader
+ * Paging is already enabled with the kernel running in the higher half.
+ * 
+ * @param multiboot_info physical address of multiboot information provided by bootloader
  */
 extern "C" void main(boot::MultibootInfo *multiboot_info)
 {
+    /* Boot information is accessed through the kernel direct map */
+    multiboot_info = (boot::MultibootInfo *)phys_to_virt((uintptr_t)multiboot_info);
+
     /* Initialize the system console */
     console.initialize(VGA_COLOR_BLACK, VGA_COLOR_LIGHT_GREY);
     console.printf("Kernel boot sequence started...\n");
@@ -0,0 +1,11 @@
+/**
+ * Header file containing the processor cache geometry of the x86 arch.
+ */
+
+#ifndef ARCH_CACHE_HPP
+#define ARCH_CACHE_HPP
+
+/** L1 data cache line size in bytes */
+#define L1_CACHE_BYTES 64
+
+#endif /* ARCH_CACHE_HPP */
@@ -24,6 +24,7 @@
 #define ISR_SERIAL2 35
 #define ISR_SERIAL1 36
 #define ISR_SYSCALL 128
+#define ISR_APIC_SPURIOUS 255
 
 namespace kernel
 {
@@ -45,6 +46,7 @@ namespace kernel
         uint32_t edx;      /* pushed by pusha */
         uint32_t ecx;      /* pushed by pusha */
         uint32_t eax;      /* pushed by pusha */
+        uint32_t vector;   /* vector number pushed by the entry stub */
         uint32_t err_code; /* error code pushed by the processor on exception */
         uint32_t eip;      /* pushed by the processor */
         uint32_t cs;       /* pushed by the processor */
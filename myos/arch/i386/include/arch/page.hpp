@@ -0,0 +1,87 @@
+/**
+ * Header file containing the page size and kernel memory layout of the
+ * x86 arch.
+ *
+ * The kernel is linked in the higher half at `KERNEL_VIRTUAL_BASE`, where
+ * physical memory up to `LOWMEM_SIZE` is mapped linearly. The last 4 MiB
+ * of the address space map the page tables of the current address space.
+ */
+
+#ifndef ARCH_PAGE_HPP
+#define ARCH_PAGE_HPP
+
+#include <stdint.h>
+
+/** Page size shift */
+#define PAGE_SHIFT 12
+
+/** Page size in bytes */
+#define PAGE_SIZE (1ul << PAGE_SHIFT)
+
+/** Page frame number of a physical address */
+#define PFN(addr) ((addr) >> PAGE_SHIFT)
+
+/** Round an address up to the next page boundary */
+#define PAGE_ALIGN(addr) (((addr) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+
+//-----------------------------------------------
+//	Kernel memory layout
+//-----------------------------------------------
+
+/** Virtual address of physical address zero in the kernel direct map */
+#define KERNEL_VIRTUAL_BASE 0xC0000000ul
+
+/** Physical memory reachable through the direct map, 896 MiB */
+#define LOWMEM_SIZE 0x38000000ul
+
+/** Physical memory mapped by the boot page tables, 16 MiB */
+#define BOOT_MAPPED_SIZE 0x01000000ul
+
+/** Start of the window for device memory mappings, past the direct map */
+#define IOREMAP_START (KERNEL_VIRTUAL_BASE + LOWMEM_SIZE)
+
+/** End of the device memory window, the page tables are mapped above */
+#define IOREMAP_END 0xFFC00000ul
+
+//-----------------------------------------------
+//	Page protection flags
+//-----------------------------------------------
+
+#define PAGE_PRESENT 0x001      // page is mapped
+#define PAGE_WRITE 0x002        // page is writable
+#define PAGE_USER 0x004         // page is accessible from user mode
+#define PAGE_WRITETHROUGH 0x008 // write through caching
+#define PAGE_NOCACHE 0x010      // caching disabled
+#define PAGE_ACCESSED 0x020     // set by the processor on access
+#define PAGE_DIRTY 0x040        // set by the processor on write
+#define PAGE_GLOBAL 0x100       // kept in the TLB across address space switches
+
+/** Protection of kernel data pages */
+#define PAGE_KERNEL (PAGE_PRESENT | PAGE_WRITE)
+
+/** Protection of device memory pages */
+#define PAGE_KERNEL_IO (PAGE_PRESENT | PAGE_WRITE | PAGE_WRITETHROUGH | PAGE_NOCACHE)
+
+/**
+ * Get the direct map address of a physical address below `LOWMEM_SIZE`.
+ *
+ * @param addr physical address
+ * @returns kernel virtual address
+ */
+static inline void *phys_to_virt(uintptr_t addr)
+{
+    return (void *)(addr + KERNEL_VIRTUAL_BASE);
+}
+
+/**
+ * Get the physical address of a direct map or kernel image address.
+ *
+ * @param addr kernel virtual address
+ * @returns physical address
+ */
+static inline uintptr_t virt_to_phys(const void *addr)
+{
+    return (uintptr_t)addr - KERNEL_VIRTUAL_BASE;
+}
+
+#endif /* ARCH_PAGE_HPP */
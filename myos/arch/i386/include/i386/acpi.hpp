@@ -0,0 +1,71 @@
+/**
+ * Advanced Configuration and Power Interface (ACPI) tables
+ *
+ * Only the Multiple APIC Description Table (MADT) describing the interrupt
+ * controllers is parsed for now.
+ */
+
+#ifndef ARCH_I386_ACPI_HPP
+#define ARCH_I386_ACPI_HPP
+
+#include <stdint.h>
+
+/** Maximum number of IOAPICs tracked */
+#define ACPI_MAX_IOAPICS 4
+
+/** Number of legacy ISA interrupt lines */
+#define ACPI_ISA_IRQS 16
+
+//-----------------------------------------------
+//	MPS INTI flags of interrupt source overrides
+//-----------------------------------------------
+
+#define ACPI_INTI_POLARITY_MASK 0x3
+#define ACPI_INTI_POLARITY_LOW 0x3 // active low
+#define ACPI_INTI_TRIGGER_MASK 0xC
+#define ACPI_INTI_TRIGGER_LEVEL 0xC // level triggered
+
+namespace I386
+{
+    namespace ACPI
+    {
+        /**
+         * IOAPIC description
+         */
+        struct IOAPICInfo
+        {
+            uint8_t id;        /**< IOAPIC ID */
+            uint32_t address;  /**< Physical address of registers */
+            uint32_t gsi_base; /**< First global system interrupt served */
+        };
+
+        /**
+         * Interrupt controller configuration described by the MADT
+         */
+        struct MADTInfo
+        {
+            uint32_t lapic_address;               /**< Physical address of local APIC registers */
+            bool pic_present;                     /**< Dual 8259 PICs are installed */
+            uint32_t nr_cpus;                     /**< Number of enabled processors */
+            uint32_t nr_ioapics;                  /**< Number of IOAPICs */
+            IOAPICInfo ioapics[ACPI_MAX_IOAPICS]; /**< IOAPICs */
+            uint32_t isa_gsi[ACPI_ISA_IRQS];      /**< Global system interrupt of each ISA line */
+            uint16_t isa_flags[ACPI_ISA_IRQS];    /**< MPS INTI flags of each ISA line */
+        };
+
+        /**
+         * Find and parse the MADT.
+         *
+         * ISA lines without an interrupt source override are identity
+         * mapped to global system interrupts with bus default flags.
+         *
+         * @param info pointer to configuration to fill
+         * @returns 0 on success and -1 if no valid MADT is found
+         */
+        int parse_madt(MADTInfo *info);
+
+    } // namespace ACPI
+
+} // namespace I386
+
+#endif /* ARCH_I386_ACPI_HPP */
@@ -0,0 +1,67 @@
+/**
+ * Local APIC and IOAPIC interrupt controllers
+ *
+ * The IOAPIC routes the legacy ISA interrupt lines to the same vectors
+ * used with the 8259 PICs, so drivers do not depend on the active
+ * controller. Interrupts are acknowledged with a single MMIO write to
+ * the local APIC.
+ */
+
+#ifndef ARCH_I386_APIC_HPP
+#define ARCH_I386_APIC_HPP
+
+#include <stdint.h>
+
+namespace I386
+{
+    namespace APIC
+    {
+        /**
+         * Initialize local APIC and route ISA interrupt lines through the
+         * IOAPIC.
+         *
+         * @returns 0 on success and -1 if no usable APIC is found
+         */
+        int setup();
+
+        /**
+         * Mask ISA interrupt line
+         *
+         * @param n ISA interrupt line to mask
+         */
+        void mask(uint8_t n);
+
+        /**
+         * Unmask ISA interrupt line
+         *
+         * @param n ISA interrupt line to unmask
+         */
+        void unmask(uint8_t n);
+
+        /**
+         * Check for the spurious interrupt vector
+         *
+         * @param n interrupt number of the triggered interrupt
+         * @returns true if the interrupt is spurious and must be dropped
+         */
+        bool spurious(uint32_t n);
+
+        /**
+         * End Of Interrupt (EOI)
+         *
+         * @param n interrupt number of the triggered interrupt
+         */
+        void eoi(uint32_t n);
+
+        /**
+         * Get number of spurious local APIC interrupts.
+         *
+         * @returns number of spurious interrupts
+         */
+        uint32_t get_spurious();
+
+    } // namespace APIC
+
+} // namespace I386
+
+#endif /* ARCH_I386_APIC_HPP */
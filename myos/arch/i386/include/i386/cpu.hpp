@@ -0,0 +1,175 @@
+/**
+ * CPU identification and control register routines
+ */
+
+#ifndef ARCH_I386_CPU_HPP
+#define ARCH_I386_CPU_HPP
+
+#include <stdint.h>
+
+//-----------------------------------------------
+//	Control register bits
+//-----------------------------------------------
+
+#define CR0_MP 0x00000002 // monitor coprocessor
+#define CR0_EM 0x00000004 // x87 FPU emulation
+#define CR0_TS 0x00000008 // task switched
+#define CR0_NE 0x00000020 // native x87 FPU error reporting
+#define CR0_WP 0x00010000 // supervisor writes honor read-only pages
+#define CR0_PG 0x80000000 // paging enabled
+
+#define CR4_PSE 0x00000010        // 4 MiB pages
+#define CR4_PGE 0x00000080        // global pages
+#define CR4_OSFXSR 0x00000200     // FXSAVE/FXRSTOR and SSE enabled by OS
+#define CR4_OSXMMEXCPT 0x00000400 // unmasked SIMD exceptions enabled by OS
+
+//-----------------------------------------------
+//	CPUID feature bits
+//-----------------------------------------------
+
+#define CPUID_LEAF_FEATURES 0x00000001
+#define CPUID_LEAF_EXT_MAX 0x80000000 // highest extended leaf
+#define CPUID_LEAF_EXT_POWER 0x80000007
+
+#define CPUID_EDX_FPU 0x00000001  // x87 FPU on chip
+#define CPUID_EDX_PSE 0x00000008  // 4 MiB pages
+#define CPUID_EDX_TSC 0x00000010  // time stamp counter
+#define CPUID_EDX_APIC 0x00000200 // local APIC on chip
+#define CPUID_EDX_PGE 0x00002000  // global pages
+#define CPUID_EDX_FXSR 0x01000000 // FXSAVE/FXRSTOR
+#define CPUID_EDX_SSE 0x02000000  // SSE
+
+#define CPUID_EDX_INVARIANT_TSC 0x00000100 // constant rate TSC, extended power leaf
+
+namespace I386
+{
+    namespace CPU
+    {
+        /**
+         * CPUID result registers
+         */
+        struct CPUIDRegs
+        {
+            uint32_t eax;
+            uint32_t ebx;
+            uint32_t ecx;
+            uint32_t edx;
+        };
+
+        /**
+         * Query processor identification and features.
+         *
+         * @param leaf CPUID leaf
+         * @param regs pointer to registers to fill
+         */
+        static inline void cpuid(uint32_t leaf, CPUIDRegs *regs)
+        {
+            asm volatile("cpuid"
+                         : "=a"(regs->eax), "=b"(regs->ebx), "=c"(regs->ecx), "=d"(regs->edx)
+                         : "a"(leaf), "c"(0));
+        }
+
+        static inline uint32_t read_cr0(void)
+        {
+            uint32_t value;
+            asm volatile("movl %%cr0, %0"
+                         : "=r"(value));
+            return value;
+        }
+
+        static inline void write_cr0(uint32_t value)
+        {
+            asm volatile("movl %0, %%cr0"
+                         :
+                         : "r"(value)
+                         : "memory");
+        }
+
+        static inline uint32_t read_cr2(void)
+        {
+            uint32_t value;
+            asm volatile("movl %%cr2, %0"
+                         : "=r"(value));
+            return value;
+        }
+
+        static inline uint32_t read_cr3(void)
+        {
+            uint32_t value;
+            asm volatile("movl %%cr3, %0"
+                         : "=r"(value));
+            return value;
+        }
+
+        /**
+         * Load the page directory base register. Flushes all non-global
+         * TLB entries.
+         *
+         * @param value physical address of the page directory
+         */
+        static inline void write_cr3(uint32_t value)
+        {
+            asm volatile("movl %0, %%cr3"
+                         :
+                         : "r"(value)
+                         : "memory");
+        }
+
+        static inline uint32_t read_cr4(void)
+        {
+            uint32_t value;
+            asm volatile("movl %%cr4, %0"
+                         : "=r"(value));
+            return value;
+        }
+
+        static inline void write_cr4(uint32_t value)
+        {
+            asm volatile("movl %0, %%cr4"
+                         :
+                         : "r"(value)
+                         : "memory");
+        }
+
+        /**
+         * Invalidate the TLB entry of a page.
+         *
+         * @param addr virtual address in the page
+         */
+        static inline void invlpg(const void *addr)
+        {
+            asm volatile("invlpg (%0)"
+                         :
+                         : "r"(addr)
+                         : "memory");
+        }
+
+        /**
+         * Read time stamp counter.
+         *
+         * @returns processor cycles since reset
+         */
+        static inline uint64_t rdtsc(void)
+        {
+            uint64_t value;
+            asm volatile("rdtsc"
+                         : "=A"(value));
+            return value;
+        }
+
+        /**
+         * Clear the task switched flag in CR0.
+         */
+        static inline void clts(void)
+        {
+            asm volatile("clts"
+                         :
+                         :
+                         : "memory");
+        }
+
+    } // namespace CPU
+
+} // namespace I386
+
+#endif /* ARCH_I386_CPU_HPP */
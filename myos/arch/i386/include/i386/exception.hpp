@@ -13,58 +13,58 @@ namespace I386
     /**
      * Divide by zero fault
      */
-    void divide_by_zero_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult divide_by_zero_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** single step */
-    void single_step_trap(kernel::ISRFrame *const frame);
+    kernel::ISRResult single_step_trap(kernel::ISRFrame *const frame, void *ctx);
 
     /** non maskable interrupt trap */
-    void nmi_trap(kernel::ISRFrame *const frame);
+    kernel::ISRResult nmi_trap(kernel::ISRFrame *const frame, void *ctx);
 
     /** breakpoint hit */
-    void breakpoint_trap(kernel::ISRFrame *const frame);
+    kernel::ISRResult breakpoint_trap(kernel::ISRFrame *const frame, void *ctx);
 
     /** overflow */
-    void overflow_trap(kernel::ISRFrame *const frame);
+    kernel::ISRResult overflow_trap(kernel::ISRFrame *const frame, void *ctx);
 
     /** bounds check */
-    void bounds_check_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult bounds_check_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** invalid opcode / instruction */
-    void invalid_opcode_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult invalid_opcode_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** device not available */
-    void no_device_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult no_device_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** double fault */
-    void double_fault_abort(kernel::ISRFrame *const frame);
+    kernel::ISRResult double_fault_abort(kernel::ISRFrame *const frame, void *ctx);
 
     /** invalid Task frame Segment (TSS) */
-    void invalid_tss_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult invalid_tss_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** segment not present */
-    void no_segment_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult no_segment_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** stack fault */
-    void stack_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult stack_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** general protection fault */
-    void general_protection_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult general_protection_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** page fault */
-    void page_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult page_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** Floating Point Unit (FPU) error */
-    void fpu_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult fpu_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** alignment check */
-    void alignment_check_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult alignment_check_fault(kernel::ISRFrame *const frame, void *ctx);
 
     /** machine check */
-    void machine_check_abort(kernel::ISRFrame *const frame);
+    kernel::ISRResult machine_check_abort(kernel::ISRFrame *const frame, void *ctx);
 
     /** Floating Point Unit (FPU) Single Instruction Multiple Data (SIMD) error */
-    void simd_fpu_fault(kernel::ISRFrame *const frame);
+    kernel::ISRResult simd_fpu_fault(kernel::ISRFrame *const frame, void *ctx);
 
 } // namespace I386
 
@@ -0,0 +1,59 @@
+/**
+ * x87 FPU and SSE state management
+ *
+ * FPU/SSE state is switched lazily. Switching contexts only sets the
+ * CR0.TS flag, so the next FPU or SSE instruction raises a device not
+ * available (#NM) fault. The fault handler saves the state of the previous
+ * owner and restores the state of the current context. Contexts never
+ * touching FPU/SSE state never pay for a save or restore.
+ */
+
+#ifndef ARCH_I386_FPU_HPP
+#define ARCH_I386_FPU_HPP
+
+#include <stdint.h>
+
+/** Size of FXSAVE area. FSAVE needs only the first 108 bytes. */
+#define FPU_STATE_SIZE 512
+
+namespace I386
+{
+    namespace FPU
+    {
+        /**
+         * FPU/SSE context of a thread.
+         */
+        struct __attribute__((aligned(16))) Context
+        {
+            uint8_t state[FPU_STATE_SIZE]; /**< FXSAVE or FSAVE area */
+            bool used;                     /**< State was loaded at least once */
+        };
+
+        /**
+         * Initialize FPU and enable SSE when supported.
+         *
+         * @returns 0 on success and -1 if no FPU is present
+         */
+        int setup();
+
+        /**
+         * Make a context current on context switch.
+         *
+         * Its state is restored on its first FPU/SSE instruction.
+         *
+         * @param ctx pointer to context
+         */
+        void switch_to(Context *ctx);
+
+        /**
+         * Drop a context before its memory is freed.
+         *
+         * @param ctx pointer to context
+         */
+        void release(Context *ctx);
+
+    } // namespace FPU
+
+} // namespace I386
+
+#endif /* ARCH_I386_FPU_HPP */
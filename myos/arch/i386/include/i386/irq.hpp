@@ -0,0 +1,76 @@
+/**
+ * Interrupt controller abstraction
+ *
+ * Hardware interrupts are routed by the local APIC and IOAPIC when
+ * available, with the legacy 8259 PICs as fallback. The active controller
+ * is selected once at boot.
+ */
+
+#ifndef ARCH_I386_IRQ_HPP
+#define ARCH_I386_IRQ_HPP
+
+#include <stdint.h>
+
+namespace I386
+{
+    /**
+     * Interrupt controller operations
+     */
+    struct IRQChip
+    {
+        const char *name;             /**< Controller name */
+        void (*mask)(uint8_t n);      /**< Mask ISA interrupt line */
+        void (*unmask)(uint8_t n);    /**< Unmask ISA interrupt line */
+        bool (*spurious)(uint32_t n); /**< Check and acknowledge spurious interrupt */
+        void (*eoi)(uint32_t n);      /**< Acknowledge interrupt number */
+        bool nested;                  /**< Higher priority lines preempt a line in service */
+    };
+
+    namespace IRQ
+    {
+        /**
+         * Select and initialize the interrupt controller.
+         */
+        void setup();
+
+        /**
+         * Get the active interrupt controller.
+         *
+         * @returns pointer to controller operations
+         */
+        const IRQChip *get_chip();
+
+        /**
+         * Mask interrupt line on the active controller
+         *
+         * @param n ISA interrupt line to mask
+         */
+        void mask(uint8_t n);
+
+        /**
+         * Unmask interrupt line on the active controller
+         *
+         * @param n ISA interrupt line to unmask
+         */
+        void unmask(uint8_t n);
+
+        /**
+         * Check for a spurious interrupt on the active controller
+         *
+         * @param n interrupt number of the triggered interrupt
+         * @returns true if the interrupt is spurious and must be dropped
+         */
+        bool spurious(uint32_t n);
+
+        /**
+         * End Of Interrupt (EOI) on the active controller
+         *
+         * @param n interrupt number of the triggered interrupt
+         */
+        void eoi(uint32_t n);
+
+    } // namespace IRQ
+
+} // namespace I386
+
+#endif /* ARCH_I386_IRQ_HPP */
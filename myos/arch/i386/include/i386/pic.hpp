@@ -50,6 +50,34 @@ namespace I386
          */
         void unmask(uint8_t n);
 
+        /**
+         * Mask all interrupt lines
+         * 
+         * Used when another interrupt controller takes over. The PICs stay 
+         * remapped so their spurious interrupts do not hit exception vectors.
+         */
+        void disable();
+
+        /**
+         * Check for a spurious interrupt
+         * 
+         * Reads the in-service register of the PIC raising the interrupt.
+         * A spurious interrupt is counted and acknowledged as required: no
+         * EOI for the master and an EOI only to the master for the slave.
+         * 
+         * @param n interrupt number of the triggered interrupt
+         * @returns true if the interrupt is spurious and must be dropped
+         */
+        bool spurious(uint32_t n);
+
+        /**
+         * Get number of spurious interrupts on an interrupt line
+         * 
+         * @param n interrupt line
+         * @returns number of spurious interrupts
+         */
+        uint32_t get_spurious(uint8_t n);
+
         /**
          * End Of Interrupt (EOI)
          * 
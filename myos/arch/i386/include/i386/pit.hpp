@@ -1,10 +1,16 @@
 /**
  * 8253 Programmable Interval Timer
+ * 
+ * Counter 0 raises the periodic system clock tick. While the CPU idles
+ * the tick can be stopped by programming a one-shot interrupt at the
+ * next timer deadline instead.
  */
 
 #ifndef ARCH_I386_PIT_HPP
 #define ARCH_I386_PIT_HPP
 
+#include <stdint.h>
+
 namespace I386
 {
     namespace PIT
@@ -21,6 +27,43 @@ namespace I386
          */
         uint32_t get_ticks();
 
+        /**
+         * Get 64-bit PIT clock ticks
+         * 
+         * @returns PIT clock ticks, never wrapping around
+         */
+        uint64_t get_ticks64();
+
+        /**
+         * Stop the periodic tick and program a one-shot interrupt.
+         * 
+         * The delay is clamped to the longest one the 16-bit counter
+         * can time, about 54 ticks. Must be called with interrupts
+         * disabled.
+         * 
+         * @param delta delay in ticks
+         * @returns delay programmed in ticks, 0 if the tick was not stopped
+         */
+        uint32_t set_oneshot(uint32_t delta);
+
+        /**
+         * Restart the periodic tick stopped by `set_oneshot`.
+         * 
+         * Ticks elapsed while stopped are accounted for. Must be called
+         * with interrupts disabled.
+         */
+        void set_periodic();
+
+        /**
+         * Measure the TSC frequency against counter 2.
+         * 
+         * Counter 2 is gated through system control port B and does not
+         * disturb the system clock tick.
+         * 
+         * @returns TSC frequency in kHz or 0 if the measurement failed
+         */
+        uint32_t calibrate_tsc();
+
     } // namespace PIT
 
 } // namespace I386
@@ -0,0 +1,29 @@
+/**
+ * CMOS Real Time Clock (RTC)
+ *
+ * The battery backed RTC keeps the date and time across power cycles.
+ * It is read once at boot to seed the wall clock. The RTC is assumed to
+ * run in UTC.
+ */
+
+#ifndef ARCH_I386_RTC_HPP
+#define ARCH_I386_RTC_HPP
+
+#include <stdint.h>
+
+namespace I386
+{
+    namespace RTC
+    {
+        /**
+         * Read the RTC date and time.
+         *
+         * @returns seconds since the Unix epoch
+         */
+        uint64_t read_time();
+
+    } // namespace RTC
+
+} // namespace I386
+
+#endif /* ARCH_I386_RTC_HPP */
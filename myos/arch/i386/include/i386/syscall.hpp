@@ -0,0 +1,21 @@
+/**
+ * x86 system call trap
+ */
+
+#ifndef ARCH_I386_SYSCALL_HPP
+#define ARCH_I386_SYSCALL_HPP
+
+#include <kernel/isr.hpp>
+
+namespace I386
+{
+    /**
+     * System call trap raised by int 0x80. The system call number is
+     * passed in eax and the arguments in ebx, ecx and edx. The result is
+     * returned in eax.
+     */
+    kernel::ISRResult syscall_trap(kernel::ISRFrame *const frame, void *ctx);
+
+} // namespace I386
+
+#endif /* ARCH_I386_SYSCALL_HPP */
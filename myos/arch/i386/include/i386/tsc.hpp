@@ -0,0 +1,58 @@
+/**
+ * Time Stamp Counter (TSC) clock source
+ *
+ * The TSC frequency is measured against the PIT at boot. Converting TSC
+ * cycles to nanoseconds then takes a multiply and a shift, so reading the
+ * clock needs no port I/O.
+ */
+
+#ifndef ARCH_I386_TSC_HPP
+#define ARCH_I386_TSC_HPP
+
+#include <stdint.h>
+
+namespace I386
+{
+    namespace TSC
+    {
+        /**
+         * Detect and calibrate the TSC.
+         *
+         * @returns 0 on success and -1 if no usable TSC is found
+         */
+        int setup();
+
+        /**
+         * Check if the TSC is calibrated and usable as clock source.
+         *
+         * @returns true if the TSC is usable
+         */
+        bool available();
+
+        /**
+         * Check if the TSC runs at a constant rate in all processor
+         * power and performance states.
+         *
+         * @returns true if the TSC is invariant
+         */
+        bool invariant();
+
+        /**
+         * Get the calibrated TSC frequency.
+         *
+         * @returns TSC frequency in kHz
+         */
+        uint32_t get_khz();
+
+        /**
+         * Get nanoseconds elapsed since calibration.
+         *
+         * @returns monotonic nanoseconds
+         */
+        uint64_t get_ns();
+
+    } // namespace TSC
+
+} // namespace I386
+
+#endif /* ARCH_I386_TSC_HPP */
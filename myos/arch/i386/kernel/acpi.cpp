@@ -0,0 +1,292 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kernel/paging.hpp>
+
+#include <i386/acpi.hpp>
+
+//-----------------------------------------------
+//	Table locations
+//-----------------------------------------------
+
+#define BDA_EBDA_SEGMENT 0x40E // BIOS data area word holding EBDA segment
+#define EBDA_SEARCH_SIZE 1024  // RSDP lies in the first KiB of the EBDA
+#define BIOS_ROM_START 0xE0000 // RSDP search range in BIOS read-only memory
+#define BIOS_ROM_END 0x100000
+#define RSDP_ALIGN 16
+
+//-----------------------------------------------
+//	MADT entry types
+//-----------------------------------------------
+
+#define MADT_LAPIC 0
+#define MADT_IOAPIC 1
+#define MADT_ISO 2
+
+#define MADT_FLAG_PCAT_COMPAT 0x1 // dual 8259 PICs installed
+#define MADT_LAPIC_ENABLED 0x1    // processor is usable
+
+/**
+ * Root System Description Pointer
+ */
+struct __attribute__((packed)) RSDP
+{
+    char signature[8]; // "RSD PTR "
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt_address;
+};
+
+/**
+ * System description table header
+ */
+struct __attribute__((packed)) SDTHeader
+{
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+};
+
+/**
+ * Multiple APIC Description Table header. Variable length interrupt
+ * controller entries follow.
+ */
+struct __attribute__((packed)) MADT
+{
+    SDTHeader header;
+    uint32_t lapic_address;
+    uint32_t flags;
+};
+
+struct __attribute__((packed)) MADTEntry
+{
+    uint8_t type;
+    uint8_t length;
+};
+
+struct __attribute__((packed)) MADTLAPIC
+{
+    MADTEntry entry;
+    uint8_t processor_id;
+    uint8_t apic_id;
+    uint32_t flags;
+};
+
+struct __attribute__((packed)) MADTIOAPIC
+{
+    MADTEntry entry;
+    uint8_t id;
+    uint8_t reserved;
+    uint32_t address;
+    uint32_t gsi_base;
+};
+
+struct __attribute__((packed)) MADTISO
+{
+    MADTEntry entry;
+    uint8_t bus;
+    uint8_t source;
+    uint32_t gsi;
+    uint16_t flags;
+};
+
+/**
+ * Check a table sums to zero
+ *
+ * @param p pointer to table
+ * @param length table length in bytes
+ * @returns true if checksum is valid
+ */
+static bool checksum_ok(const void *p, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)p;
+    uint8_t sum = 0;
+
+    for (size_t i = 0; i < length; i++)
+        sum += bytes[i];
+
+    return sum == 0;
+}
+
+/**
+ * Search a physical memory range for the RSDP
+ *
+ * @param start first address of range
+ * @param end address past the range
+ * @returns pointer to RSDP or nullptr if not found
+ */
+static const RSDP *find_rsdp_in(uintptr_t start, uintptr_t end)
+{
+    // The first MiB is always in the direct map
+    for (uintptr_t addr = start; addr + sizeof(RSDP) <= end; addr += RSDP_ALIGN)
+    {
+        const RSDP *rsdp = (const RSDP *)phys_to_virt(addr);
+        if (memcmp(rsdp->signature, "RSD PTR ", 8) == 0 && checksum_ok(rsdp, sizeof(RSDP)))
+            return rsdp;
+    }
+    return nullptr;
+}
+
+/**
+ * Find the RSDP in the EBDA or the BIOS read-only memory
+ *
+ * @returns pointer to RSDP or nullptr if not found
+ */
+static const RSDP *find_rsdp()
+{
+    uintptr_t ebda = (uintptr_t)(*(const uint16_t *)phys_to_virt(BDA_EBDA_SEGMENT)) << 4;
+    const RSDP *rsdp = nullptr;
+
+    if (ebda)
+        rsdp = find_rsdp_in(ebda, ebda + EBDA_SEARCH_SIZE);
+    if (rsdp == nullptr)
+        rsdp = find_rsdp_in(BIOS_ROM_START, BIOS_ROM_END);
+
+    return rsdp;
+}
+
+/**
+ * Map a table into the kernel address space
+ *
+ * @param addr physical address of table
+ * @returns pointer to table header or nullptr if out of address space
+ */
+static const SDTHeader *map_table(uintptr_t addr)
+{
+    const SDTHeader *header = (const SDTHeader *)kernel::Paging::ioremap(addr, sizeof(SDTHeader));
+    if (header == nullptr)
+        return nullptr;
+
+    uint32_t length = header->length;
+    kernel::Paging::iounmap((void *)header, sizeof(SDTHeader));
+    if (length < sizeof(SDTHeader))
+        return nullptr;
+
+    return (const SDTHeader *)kernel::Paging::ioremap(addr, length);
+}
+
+/**
+ * Unmap a table mapped by `map_table`
+ *
+ * @param table pointer to table header
+ */
+static void unmap_table(const SDTHeader *table)
+{
+    kernel::Paging::iounmap((void *)table, table->length);
+}
+
+/**
+ * Find a table listed in the RSDT
+ *
+ * @param rsdp pointer to RSDP
+ * @param signature table signature
+ * @returns pointer to table header to unmap after use or nullptr if not found
+ */
+static const SDTHeader *find_table(const RSDP *rsdp, const char *signature)
+{
+    const SDTHeader *rsdt = map_table(rsdp->rsdt_address);
+    const SDTHeader *found = nullptr;
+
+    if (rsdt == nullptr)
+        return nullptr;
+    if (memcmp(rsdt->signature, "RSDT", 4) != 0 || !checksum_ok(rsdt, rsdt->length))
+    {
+        unmap_table(rsdt);
+        return nullptr;
+    }
+
+    const uint32_t *entries = (const uint32_t *)(rsdt + 1);
+    size_t count = (rsdt->length - sizeof(SDTHeader)) / sizeof(uint32_t);
+
+    for (size_t i = 0; i < count && found == nullptr; i++)
+    {
+        const SDTHeader *table = map_table(entries[i]);
+        if (table == nullptr)
+            continue;
+
+        if (memcmp(table->signature, signature, 4) == 0 && checksum_ok(table, table->length))
+            found = table;
+        else
+            unmap_table(table);
+    }
+
+    unmap_table(rsdt);
+    return found;
+}
+
+int I386::ACPI::parse_madt(I386::ACPI::MADTInfo *info)
+{
+    const RSDP *rsdp = find_rsdp();
+    if (rsdp == nullptr)
+        return -1;
+
+    const MADT *madt = (const MADT *)find_table(rsdp, "APIC");
+    if (madt == nullptr)
+        return -1;
+
+    info->lapic_address = madt->lapic_address;
+    info->pic_present = madt->flags & MADT_FLAG_PCAT_COMPAT;
+    info->nr_cpus = 0;
+    info->nr_ioapics = 0;
+    for (uint32_t irq = 0; irq < ACPI_ISA_IRQS; irq++)
+    {
+        info->isa_gsi[irq] = irq;
+        info->isa_flags[irq] = 0;
+    }
+
+    const uint8_t *p = (const uint8_t *)(madt + 1);
+    const uint8_t *end = (const uint8_t *)madt + madt->header.length;
+
+    while (p + sizeof(MADTEntry) <= end)
+    {
+        const MADTEntry *entry = (const MADTEntry *)p;
+        if (entry->length < sizeof(MADTEntry) || p + entry->length > end)
+            break;
+
+        switch (entry->type)
+        {
+        case MADT_LAPIC:
+        {
+            const MADTLAPIC *lapic = (const MADTLAPIC *)entry;
+            if (lapic->flags & MADT_LAPIC_ENABLED)
+                info->nr_cpus++;
+            break;
+        }
+        case MADT_IOAPIC:
+        {
+            const MADTIOAPIC *ioapic = (const MADTIOAPIC *)entry;
+            if (info->nr_ioapics < ACPI_MAX_IOAPICS)
+            {
+                IOAPICInfo *io = &info->ioapics[info->nr_ioapics++];
+                io->id = ioapic->id;
+                io->address = ioapic->address;
+                io->gsi_base = ioapic->gsi_base;
+            }
+            break;
+        }
+        case MADT_ISO:
+        {
+            const MADTISO *iso = (const MADTISO *)entry;
+            if (iso->bus == 0 && iso->source < ACPI_ISA_IRQS)
+            {
+                info->isa_gsi[iso->source] = iso->gsi;
+                info->isa_flags[iso->source] = iso->flags;
+            }
+            break;
+        }
+        }
+
+        p += entry->length;
+    }
+
+    unmap_table(&madt->header);
+    return 0;
+}
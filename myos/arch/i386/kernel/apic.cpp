@@ -0,0 +1,236 @@
+#include <stdint.h>
+
+#include <kernel/isr.hpp>
+#include <kernel/paging.hpp>
+
+#include <i386/acpi.hpp>
+#include <i386/apic.hpp>
+#include <i386/cpu.hpp>
+
+//-----------------------------------------------
+//	Local APIC registers
+//-----------------------------------------------
+
+#define LAPIC_REG_ID 0x020    // local APIC ID
+#define LAPIC_REG_TPR 0x080   // task priority
+#define LAPIC_REG_EOI 0x0B0   // end of interrupt
+#define LAPIC_REG_SVR 0x0F0   // spurious interrupt vector
+#define LAPIC_REG_LINT0 0x350 // local interrupt 0 vector table entry
+
+#define LAPIC_SVR_ENABLE 0x100   // APIC software enable
+#define LAPIC_LVT_MASKED 0x10000 // local interrupt masked
+
+//-----------------------------------------------
+//	IOAPIC registers
+//-----------------------------------------------
+
+#define IOAPIC_REG_SELECT 0x00 // register select
+#define IOAPIC_REG_WINDOW 0x10 // data window
+
+#define IOAPIC_VERSION 0x01 // version and number of redirection entries
+#define IOAPIC_REDTBL 0x10  // first redirection entry, two registers each
+
+#define IOAPIC_REDIR_POLARITY_LOW 0x00002000  // active low
+#define IOAPIC_REDIR_TRIGGER_LEVEL 0x00008000 // level triggered
+#define IOAPIC_REDIR_MASKED 0x00010000        // interrupt masked
+#define IOAPIC_REDIR_DEST_SHIFT 24            // destination APIC ID in high register
+
+/**
+ * IOAPIC state
+ */
+struct IOAPIC
+{
+    volatile uint32_t *regs; // register window
+    uint32_t gsi_base;       // first global system interrupt
+    uint32_t nr_redirs;      // number of redirection entries
+};
+
+static volatile uint32_t *lapic = nullptr;
+static IOAPIC ioapics[ACPI_MAX_IOAPICS];
+static uint32_t nr_ioapics = 0;
+static uint32_t isa_gsi[ACPI_ISA_IRQS];
+static volatile uint32_t spurious_count = 0;
+
+static inline uint32_t lapic_read(uint32_t reg)
+{
+    return lapic[reg / sizeof(uint32_t)];
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value)
+{
+    lapic[reg / sizeof(uint32_t)] = value;
+}
+
+static inline uint32_t ioapic_read(IOAPIC *io, uint32_t reg)
+{
+    io->regs[IOAPIC_REG_SELECT / sizeof(uint32_t)] = reg;
+    return io->regs[IOAPIC_REG_WINDOW / sizeof(uint32_t)];
+}
+
+static inline void ioapic_write(IOAPIC *io, uint32_t reg, uint32_t value)
+{
+    io->regs[IOAPIC_REG_SELECT / sizeof(uint32_t)] = reg;
+    io->regs[IOAPIC_REG_WINDOW / sizeof(uint32_t)] = value;
+}
+
+/**
+ * Find the IOAPIC serving a global system interrupt
+ *
+ * @param gsi global system interrupt
+ * @param pin pointer to store the IOAPIC input pin
+ * @returns pointer to IOAPIC or nullptr if none serves the interrupt
+ */
+static IOAPIC *find_ioapic(uint32_t gsi, uint32_t *pin)
+{
+    for (uint32_t i = 0; i < nr_ioapics; i++)
+    {
+        if (gsi >= ioapics[i].gsi_base && gsi < ioapics[i].gsi_base + ioapics[i].nr_redirs)
+        {
+            *pin = gsi - ioapics[i].gsi_base;
+            return &ioapics[i];
+        }
+    }
+    return nullptr;
+}
+
+int I386::APIC::setup()
+{
+    I386::CPU::CPUIDRegs regs;
+    I386::ACPI::MADTInfo madt;
+
+    I386::CPU::cpuid(CPUID_LEAF_FEATURES, &regs);
+    if (!(regs.edx & CPUID_EDX_APIC))
+        return -1;
+    if (I386::ACPI::parse_madt(&madt) || madt.nr_ioapics == 0)
+        return -1;
+
+    // Map the controller registers uncached
+    lapic = (volatile uint32_t *)kernel::Paging::ioremap(madt.lapic_address, PAGE_SIZE);
+    if (lapic == nullptr)
+        return -1;
+    for (uint32_t i = 0; i < madt.nr_ioapics; i++)
+    {
+        ioapics[i].regs = (volatile uint32_t *)kernel::Paging::ioremap(madt.ioapics[i].address, PAGE_SIZE);
+        if (ioapics[i].regs == nullptr)
+        {
+            // Give the window back before falling back to the PICs
+            while (i--)
+            {
+                kernel::Paging::iounmap((void *)ioapics[i].regs, PAGE_SIZE);
+                ioapics[i].regs = nullptr;
+            }
+            kernel::Paging::iounmap((void *)lapic, PAGE_SIZE);
+            lapic = nullptr;
+            return -1;
+        }
+    }
+
+    // Mask all IOAPIC inputs until routed
+    nr_ioapics = madt.nr_ioapics;
+    for (uint32_t i = 0; i < nr_ioapics; i++)
+    {
+        IOAPIC *io = &ioapics[i];
+        io->gsi_base = madt.ioapics[i].gsi_base;
+        io->nr_redirs = ((ioapic_read(io, IOAPIC_VERSION) >> 16) & 0xFF) + 1;
+
+        for (uint32_t pin = 0; pin < io->nr_redirs; pin++)
+            ioapic_write(io, IOAPIC_REDTBL + 2 * pin, IOAPIC_REDIR_MASKED);
+    }
+
+    // Enable local APIC accepting all interrupt priorities
+    lapic_write(LAPIC_REG_TPR, 0);
+    lapic_write(LAPIC_REG_SVR, LAPIC_SVR_ENABLE | ISR_APIC_SPURIOUS);
+
+    // Disconnect the 8259 output wired to LINT0 in virtual wire mode
+    lapic_write(LAPIC_REG_LINT0, LAPIC_LVT_MASKED);
+
+    /**
+     * Route ISA lines to the vectors used with the PICs, delivered to the
+     * boot processor. IRQ 2 is the PIC cascade and never raised.
+     */
+    uint32_t dest = lapic_read(LAPIC_REG_ID) >> 24;
+    for (uint32_t irq = 0; irq < ACPI_ISA_IRQS; irq++)
+    {
+        uint32_t pin;
+
+        isa_gsi[irq] = madt.isa_gsi[irq];
+        if (irq == 2)
+            continue;
+
+        IOAPIC *io = find_ioapic(isa_gsi[irq], &pin);
+        if (io == nullptr)
+            continue;
+
+        // ISA lines default to active high edge triggered
+        uint32_t redir = ISR_IRQ0 + irq;
+        if ((madt.isa_flags[irq] & ACPI_INTI_POLARITY_MASK) == ACPI_INTI_POLARITY_LOW)
+            redir |= IOAPIC_REDIR_POLARITY_LOW;
+        if ((madt.isa_flags[irq] & ACPI_INTI_TRIGGER_MASK) == ACPI_INTI_TRIGGER_LEVEL)
+            redir |= IOAPIC_REDIR_TRIGGER_LEVEL;
+
+        ioapic_write(io, IOAPIC_REDTBL + 2 * pin + 1, dest << IOAPIC_REDIR_DEST_SHIFT);
+        ioapic_write(io, IOAPIC_REDTBL + 2 * pin, redir);
+    }
+
+    return 0;
+}
+
+/**
+ * Set the mask bit of the redirection entry of an ISA line
+ *
+ * @param n ISA interrupt line
+ * @param masked true to mask the line
+ */
+static void set_masked(uint8_t n, bool masked)
+{
+    uint32_t pin;
+
+    if (n >= ACPI_ISA_IRQS)
+        return;
+
+    IOAPIC *io = find_ioapic(isa_gsi[n], &pin);
+    if (io == nullptr)
+        return;
+
+    uint32_t redir = ioapic_read(io, IOAPIC_REDTBL + 2 * pin);
+    redir = masked ? redir | IOAPIC_REDIR_MASKED : redir & ~IOAPIC_REDIR_MASKED;
+    ioapic_write(io, IOAPIC_REDTBL + 2 * pin, redir);
+}
+
+void I386::APIC::mask(uint8_t n)
+{
+    set_masked(n, true);
+}
+
+void I386::APIC::unmask(uint8_t n)
+{
+    set_masked(n, false);
+}
+
+bool I386::APIC::spurious(uint32_t n)
+{
+    /**
+     * The local APIC raises the spurious vector when an interrupt is
+     * withdrawn before delivery. It must not be acknowledged.
+     */
+    if (n == ISR_APIC_SPURIOUS)
+    {
+        spurious_count++;
+        return true;
+    }
+    return false;
+}
+
+void I386::APIC::eoi(uint32_t n)
+{
+    // Exceptions and software interrupts are not acknowledged
+    if (n >= ISR_IRQ0 && n != ISR_SYSCALL)
+    {
+        lapic_write(LAPIC_REG_EOI, 0);
+    }
+}
+
+uint32_t I386::APIC::get_spurious()
+{
+    return spurious_count;
+}
@@ -0,0 +1,138 @@
+; Interrupt entry code.
+;
+; Every interrupt vector has a tiny entry stub which pushes a dummy error
+; code when the processor does not push one, pushes the vector number and
+; jumps to a single common trampoline. The trampoline saves the interrupted
+; context as an ISR stack frame (kernel::ISRFrame), calls the common
+; interrupt handler entry point kernel::IVT::isr_entry and returns to the
+; interrupted context with iret.
+;
+; Handlers run on a dedicated interrupt stack. The stack frame itself stays
+; on the interrupted stack, and nested interrupts arriving while the
+; interrupt stack is in use keep running on it.
+
+; Kernel data segment selector in GDT
+KERNEL_DATA_SEGMENT equ 0x10
+
+; Number of interrupt vectors
+IDT_MAX_DESCRIPTORS equ 256
+
+; Size of the interrupt stack
+IRQ_STACK_SIZE equ 16384
+
+; Check if the processor pushes an error code for an exception vector:
+; double fault, invalid TSS, segment not present, stack fault, general
+; protection fault, page fault, alignment check, control protection,
+; VMM communication and security exceptions.
+%define HAS_ERROR_CODE(n) ((n) == 8 || ((n) >= 10 && (n) <= 14) || (n) == 17 || (n) == 21 || (n) == 29 || (n) == 30)
+
+; Common interrupt handler entry point. The C++ symbol is exported under
+; this unmangled name.
+extern isr_entry
+
+section .text
+
+; Per-vector entry stubs.
+;
+; The stubs are kept a few bytes long so all vectors together fit in a
+; handful of cache lines. Vectors above 127 push a dword as a byte push
+; would sign extend the vector number.
+%assign vector 0
+%rep IDT_MAX_DESCRIPTORS
+isr_stub_%[vector]:
+%if !HAS_ERROR_CODE(vector)
+	push byte 0
+%endif
+%if vector < 128
+	push byte vector
+%else
+	push dword vector
+%endif
+	jmp isr_common
+%assign vector vector + 1
+%endrep
+
+; Common interrupt trampoline.
+;
+; On entry the stack holds the vector number on top of the error code and
+; the processor pushed eip, cs and eflags (and esp, ss on a privilege
+; change). Interrupts are disabled by the interrupt gate.
+align 16
+isr_common:
+	; Save edi,esi,ebp,esp,ebx,edx,ecx,eax
+	pusha
+
+	; Save the original data segment selector
+	mov eax, ds
+	push eax
+
+	; Load the kernel data segment selector
+	mov ax, KERNEL_DATA_SEGMENT
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+
+	; Push a copy of the vector number above the saved registers as the
+	; interrupt number of the stack frame. Keep a pointer to the stack
+	; frame in a callee saved register.
+	push dword [esp + 36]
+	mov ebx, esp
+
+	; Switch to the interrupt stack unless a nested interrupt is already
+	; running on it
+	mov eax, esp
+	sub eax, irq_stack_bottom
+	cmp eax, IRQ_STACK_SIZE
+	jb .on_irq_stack
+	mov esp, irq_stack_top
+.on_irq_stack:
+
+	; Pass the stack frame pointer to the common interrupt handler entry
+	; point. The ABI requires the stack to be 16-byte aligned and the
+	; direction flag to be clear on calls. Nested interrupts arrive at any
+	; stack depth, so align on both paths.
+	and esp, -16
+	sub esp, 12
+	push ebx
+	cld
+	call isr_entry
+
+	; Return to the interrupted stack and unload the interrupt number
+	mov esp, ebx
+	add esp, 4
+
+	; Reload the original data segment selector
+	pop eax
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+
+	; Restore edi,esi,ebp,esp,ebx,edx,ecx,eax
+	popa
+
+	; Unload the vector number and error code
+	add esp, 8
+
+	; Pops eip, cs and eflags (and esp, ss on a privilege change)
+	iret
+
+; Interrupt stack. Aligned on 16 bytes like the stack pointer at calls.
+section .bss
+align 16
+irq_stack_bottom:
+resb IRQ_STACK_SIZE
+irq_stack_top:
+
+; Table of entry stub addresses indexed by vector number. Used to set up
+; the IDT descriptors.
+section .rodata
+align 4
+global isr_stub_table
+isr_stub_table:
+%assign vector 0
+%rep IDT_MAX_DESCRIPTORS
+	dd isr_stub_%[vector]
+%assign vector vector + 1
+%endrep
@@ -0,0 +1,171 @@
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/isr.hpp>
+
+#include <i386/cpu.hpp>
+#include <i386/fpu.hpp>
+
+/** Device not available fault vector */
+#define ISR_NO_DEVICE 7
+
+/**
+ * FXSAVE/FXRSTOR supported. Falls back to FSAVE/FRSTOR when not.
+ */
+static bool fxsr = false;
+
+/**
+ * Clean FPU/SSE state loaded into contexts on their first use
+ */
+static I386::FPU::Context init_state;
+
+/**
+ * Context of the boot thread
+ */
+static I386::FPU::Context boot_context;
+
+/**
+ * Context of the running thread
+ */
+static I386::FPU::Context *current = &boot_context;
+
+/**
+ * Context whose state is loaded in the FPU, or nullptr if none
+ */
+static I386::FPU::Context *owner = nullptr;
+
+/**
+ * Shadow of CR0.TS avoiding needless control register writes
+ */
+static bool ts = false;
+
+/**
+ * Save FPU/SSE state into a context
+ *
+ * @param ctx pointer to context
+ */
+static inline void save(I386::FPU::Context *ctx)
+{
+    if (fxsr)
+        asm volatile("fxsave %0"
+                     : "=m"(ctx->state));
+    else
+        asm volatile("fnsave %0"
+                     : "=m"(ctx->state));
+}
+
+/**
+ * Load FPU/SSE state from a context
+ *
+ * @param ctx pointer to context
+ */
+static inline void restore(const I386::FPU::Context *ctx)
+{
+    if (fxsr)
+        asm volatile("fxrstor %0"
+                     :
+                     : "m"(ctx->state));
+    else
+        asm volatile("frstor %0"
+                     :
+                     : "m"(ctx->state));
+}
+
+/**
+ * Set or clear CR0.TS
+ *
+ * @param set true to trap the next FPU/SSE instruction
+ */
+static inline void set_ts(bool set)
+{
+    if (set == ts)
+        return;
+
+    if (set)
+        I386::CPU::write_cr0(I386::CPU::read_cr0() | CR0_TS);
+    else
+        I386::CPU::clts();
+    ts = set;
+}
+
+/**
+ * Device not available fault handler
+ *
+ * Raised by the first FPU/SSE instruction after a context switch. Hands
+ * the FPU over from its previous owner to the current context.
+ */
+static kernel::ISRResult no_device_isr(kernel::ISRFrame *const frame, void *ctx)
+{
+    set_ts(false);
+
+    if (owner != current)
+    {
+        if (owner != nullptr)
+            save(owner);
+        restore(current->used ? current : &init_state);
+        current->used = true;
+        owner = current;
+    }
+
+    return kernel::IRQ_HANDLED;
+}
+
+int I386::FPU::setup()
+{
+    I386::CPU::CPUIDRegs regs;
+
+    I386::CPU::cpuid(CPUID_LEAF_FEATURES, &regs);
+    if (!(regs.edx & CPUID_EDX_FPU))
+        return -1;
+
+    // Use the on chip FPU with native error reporting
+    uint32_t cr0 = I386::CPU::read_cr0();
+    cr0 &= ~(CR0_EM | CR0_TS);
+    cr0 |= CR0_MP | CR0_NE;
+    I386::CPU::write_cr0(cr0);
+    ts = false;
+
+    // Enable FXSAVE/FXRSTOR and SSE instructions
+    fxsr = regs.edx & CPUID_EDX_FXSR;
+    if (fxsr)
+    {
+        uint32_t cr4 = I386::CPU::read_cr4() | CR4_OSFXSR;
+        if (regs.edx & CPUID_EDX_SSE)
+            cr4 |= CR4_OSXMMEXCPT;
+        I386::CPU::write_cr4(cr4);
+    }
+
+    // Snapshot the clean state handed to contexts on first use
+    asm volatile("fninit");
+    save(&init_state);
+    init_state.used = true;
+
+    kernel::IVT::register_isr(ISR_NO_DEVICE, no_device_isr);
+
+    // Nothing owns the FPU yet
+    set_ts(true);
+
+    return 0;
+}
+
+void I386::FPU::switch_to(I386::FPU::Context *ctx)
+{
+    unsigned long flags = kernel::irq_save();
+
+    current = ctx;
+    set_ts(owner != ctx);
+
+    kernel::irq_restore(flags);
+}
+
+void I386::FPU::release(I386::FPU::Context *ctx)
+{
+    unsigned long flags = kernel::irq_save();
+
+    if (owner == ctx)
+        owner = nullptr;
+    if (current == ctx)
+        set_ts(true);
+
+    kernel::irq_restore(flags);
+}
@@ -13,11 +13,38 @@ void kernel::sti()
     asm volatile("sti");
 }
 
+unsigned long kernel::irq_save()
+{
+    unsigned long flags;
+    asm volatile("pushfl\n\t"
+                 "popl %0\n\t"
+                 "cli"
+                 : "=rm"(flags)
+                 :
+                 : "memory");
+    return flags;
+}
+
+void kernel::irq_restore(unsigned long flags)
+{
+    asm volatile("pushl %0\n\t"
+                 "popfl"
+                 :
+                 : "g"(flags)
+                 : "memory", "cc");
+}
+
 void kernel::rep_nop()
 {
     asm volatile("rep; nop");
 }
 
+void kernel::halt()
+{
+    // Interrupts are recognized only after the instruction following sti
+    asm volatile("sti; hlt" ::: "memory");
+}
+
 void kernel::hang()
 {
     asm volatile("hlt");
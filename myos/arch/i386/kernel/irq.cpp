@@ -0,0 +1,75 @@
+#include <stdint.h>
+
+#include <kernel/logging.hpp>
+
+#include <i386/apic.hpp>
+#include <i386/irq.hpp>
+#include <i386/pic.hpp>
+
+/**
+ * Legacy 8259 PIC operations
+ */
+static const I386::IRQChip pic_chip = {
+    "8259 PIC",
+    I386::PIC::mask,
+    I386::PIC::unmask,
+    I386::PIC::spurious,
+    I386::PIC::eoi,
+    true,
+};
+
+/**
+ * Local APIC and IOAPIC operations
+ */
+static const I386::IRQChip apic_chip = {
+    "IOAPIC",
+    I386::APIC::mask,
+    I386::APIC::unmask,
+    I386::APIC::spurious,
+    I386::APIC::eoi,
+    false,
+};
+
+/**
+ * Active interrupt controller
+ */
+static const I386::IRQChip *chip = &pic_chip;
+
+void I386::IRQ::setup()
+{
+    // Remap the PICs in any case so their interrupts never hit exception vectors
+    I386::PIC::setup();
+
+    if (I386::APIC::setup() == 0)
+    {
+        I386::PIC::disable();
+        chip = &apic_chip;
+    }
+
+    LOG_INFO("irq", "using %s\n", chip->name);
+}
+
+const I386::IRQChip *I386::IRQ::get_chip()
+{
+    return chip;
+}
+
+void I386::IRQ::mask(uint8_t n)
+{
+    chip->mask(n);
+}
+
+void I386::IRQ::unmask(uint8_t n)
+{
+    chip->unmask(n);
+}
+
+bool I386::IRQ::spurious(uint32_t n)
+{
+    return chip->spurious(n);
+}
+
+void I386::IRQ::eoi(uint32_t n)
+{
+    chip->eoi(n);
+}
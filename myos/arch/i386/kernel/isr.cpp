@@ -1,8 +1,35 @@
 #include <kernel/isr.hpp>
 
-#include <i386/pic.hpp>
+#include <i386/irq.hpp>
+
+/** Interrupt enable flag of EFLAGS register */
+#define EFLAGS_IF 0x200
+
+bool kernel::IVT::isr_enter(ISRFrame *const frame)
+{
+    return !I386::IRQ::spurious(frame->n);
+}
 
 void kernel::IVT::isr_exit(ISRFrame *const frame)
 {
-    I386::PIC::eoi(frame->n);
+    I386::IRQ::eoi(frame->n);
+}
+
+bool kernel::IVT::irqs_enabled(ISRFrame *const frame)
+{
+    return frame->arg.eflags & EFLAGS_IF;
+}
+
+bool kernel::IVT::irq_nestable(ISRFrame *const frame)
+{
+    /**
+     * The 8259 keeps the in-service bit of a PIC line set until EOI. In 
+     * fully nested mode only lines of higher priority are delivered. The
+     * local APIC only delivers vectors of a higher priority class than
+     * the one in service, and the ISA lines routed through the IOAPIC all
+     * share the class of vectors 0x20 to 0x2F, so they never nest.
+     */
+    if (!I386::IRQ::get_chip()->nested)
+        return false;
+    return frame->n >= ISR_IRQ0 && frame->n < ISR_IRQ0 + 16;
 }
@@ -0,0 +1,351 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kernel/frame.hpp>
+#include <kernel/ioport.hpp>
+#include <kernel/logging.hpp>
+#include <kernel/paging.hpp>
+
+#include <i386/cpu.hpp>
+
+//-----------------------------------------------
+//	Two-level page table geometry
+//-----------------------------------------------
+
+#define PAGE_TABLE_ENTRIES 1024    // entries in a page directory or table
+#define PAGE_ADDR_MASK 0xFFFFF000  // frame address of an entry
+#define PAGE_FLAGS_MASK 0x00000FFF // flags of an entry
+#define PDE_LARGE 0x080            // directory entry maps a large page
+#define LARGE_PAGE_SIZE (PAGE_SIZE * PAGE_TABLE_ENTRIES)
+#define LARGE_PAGE_MASK (~(LARGE_PAGE_SIZE - 1))
+
+#define PDE_INDEX(addr) ((addr) >> 22)
+#define PTE_INDEX(addr) (((addr) >> PAGE_SHIFT) & (PAGE_TABLE_ENTRIES - 1))
+
+/**
+ * The last page directory entry points to the page directory itself, so
+ * the page tables of the current address space appear as the last 4 MiB
+ * of virtual memory and the page directory as its last page.
+ */
+#define PAGE_TABLES_BASE 0xFFC00000
+#define PAGE_DIRECTORY_BASE 0xFFFFF000
+
+/** Pages in the device memory window */
+#define IOREMAP_PAGES ((IOREMAP_END - IOREMAP_START) >> PAGE_SHIFT)
+
+static uint32_t *const page_directory = (uint32_t *)PAGE_DIRECTORY_BASE;
+
+/**
+ * Physical address past the direct map. Only the boot page tables are
+ * set up until `init` is called.
+ */
+static uintptr_t direct_end = BOOT_MAPPED_SIZE;
+
+/** Direct map uses large pages */
+static bool large_pages = false;
+
+/** `PAGE_GLOBAL` if the processor supports global pages */
+static uint32_t global_flag = 0;
+
+/**
+ * Allocation bitmap of the device memory window, one bit per page
+ */
+static uint32_t ioremap_map[IOREMAP_PAGES / 32];
+
+static inline uint32_t *page_table(size_t pde)
+{
+    return (uint32_t *)(PAGE_TABLES_BASE + pde * PAGE_SIZE);
+}
+
+/**
+ * Get the entry flags of a mapping. Kernel mappings are shared by all
+ * address spaces and made global.
+ *
+ * @param virt virtual address
+ * @param flags page protection flags
+ * @returns page table entry flags
+ */
+static inline uint32_t pte_flags(uintptr_t virt, uint32_t flags)
+{
+    flags = (flags & PAGE_FLAGS_MASK & ~(PAGE_ACCESSED | PAGE_DIRTY | PDE_LARGE)) | PAGE_PRESENT;
+    if (virt >= KERNEL_VIRTUAL_BASE)
+        flags |= global_flag;
+    return flags;
+}
+
+/**
+ * Get the page table entry of a virtual address. Must be called with
+ * interrupts disabled.
+ *
+ * @param virt virtual address
+ * @param alloc true to allocate a missing page table
+ * @returns pointer to page table entry or nullptr if there is no page
+ *          table or the address is in a large page
+ */
+static uint32_t *get_pte(uintptr_t virt, bool alloc)
+{
+    size_t pde = PDE_INDEX(virt);
+    uint32_t *table = page_table(pde);
+
+    if (page_directory[pde] & PDE_LARGE)
+        return nullptr;
+
+    if (!(page_directory[pde] & PAGE_PRESENT))
+    {
+        if (!alloc)
+            return nullptr;
+
+        uintptr_t frame = kernel::PageFrame::alloc();
+        if (frame == 0)
+            return nullptr;
+
+        // Page table entries decide the access rights of user pages
+        uint32_t flags = PAGE_PRESENT | PAGE_WRITE;
+        if (virt < KERNEL_VIRTUAL_BASE)
+            flags |= PAGE_USER;
+
+        page_directory[pde] = frame | flags;
+        I386::CPU::invlpg(table);
+        memset(table, 0, PAGE_SIZE);
+    }
+
+    return &table[PTE_INDEX(virt)];
+}
+
+int kernel::Paging::map(uintptr_t virt, uintptr_t phys, size_t size, uint32_t flags)
+{
+    uintptr_t start = virt & PAGE_ADDR_MASK;
+    uintptr_t end = PAGE_ALIGN(virt + size);
+    int ret = 0;
+
+    phys &= PAGE_ADDR_MASK;
+
+    unsigned long irq_flags = kernel::irq_save();
+
+    for (uintptr_t addr = start; addr != end; addr += PAGE_SIZE, phys += PAGE_SIZE)
+    {
+        // The page table window is not available for mappings
+        uint32_t *pte = addr < PAGE_TABLES_BASE ? get_pte(addr, true) : nullptr;
+        if (pte == nullptr)
+        {
+            ret = -1;
+            break;
+        }
+
+        bool flush = *pte & PAGE_PRESENT;
+        *pte = phys | pte_flags(addr, flags);
+        if (flush)
+            I386::CPU::invlpg((void *)addr);
+    }
+
+    kernel::irq_restore(irq_flags);
+    return ret;
+}
+
+void kernel::Paging::unmap(uintptr_t virt, size_t size)
+{
+    uintptr_t start = virt & PAGE_ADDR_MASK;
+    uintptr_t end = PAGE_ALIGN(virt + size);
+
+    unsigned long irq_flags = kernel::irq_save();
+
+    for (uintptr_t addr = start; addr != end; addr += PAGE_SIZE)
+    {
+        uint32_t *pte = addr < PAGE_TABLES_BASE ? get_pte(addr, false) : nullptr;
+        if (pte == nullptr || !(*pte & PAGE_PRESENT))
+            continue;
+
+        *pte = 0;
+        I386::CPU::invlpg((void *)addr);
+    }
+
+    kernel::irq_restore(irq_flags);
+}
+
+int kernel::Paging::protect(uintptr_t virt, size_t size, uint32_t flags)
+{
+    uintptr_t start = virt & PAGE_ADDR_MASK;
+    uintptr_t end = PAGE_ALIGN(virt + size);
+    int ret = 0;
+
+    unsigned long irq_flags = kernel::irq_save();
+
+    for (uintptr_t addr = start; addr != end; addr += PAGE_SIZE)
+    {
+        uint32_t *pte = addr < PAGE_TABLES_BASE ? get_pte(addr, false) : nullptr;
+        if (pte == nullptr || !(*pte & PAGE_PRESENT))
+        {
+            ret = -1;
+            break;
+        }
+
+        // Keep the frame and the access state recorded by the processor
+        *pte = (*pte & (PAGE_ADDR_MASK | PAGE_ACCESSED | PAGE_DIRTY)) | pte_flags(addr, flags);
+        I386::CPU::invlpg((void *)addr);
+    }
+
+    kernel::irq_restore(irq_flags);
+    return ret;
+}
+
+int kernel::Paging::translate(uintptr_t virt, uintptr_t *phys)
+{
+    int ret = -1;
+
+    unsigned long irq_flags = kernel::irq_save();
+
+    uint32_t pde = page_directory[PDE_INDEX(virt)];
+    uint32_t *pte = get_pte(virt, false);
+    if ((pde & (PAGE_PRESENT | PDE_LARGE)) == (PAGE_PRESENT | PDE_LARGE))
+    {
+        *phys = (pde & LARGE_PAGE_MASK) | (virt & ~LARGE_PAGE_MASK);
+        ret = 0;
+    }
+    else if (pte != nullptr && (*pte & PAGE_PRESENT))
+    {
+        *phys = (*pte & PAGE_ADDR_MASK) | (virt & ~PAGE_ADDR_MASK);
+        ret = 0;
+    }
+
+    kernel::irq_restore(irq_flags);
+    return ret;
+}
+
+int kernel::Paging::init()
+{
+    I386::CPU::CPUIDRegs regs;
+    int ret = 0;
+    uintptr_t limit = PAGE_ALIGN(kernel::PageFrame::get_limit());
+
+    if (limit < BOOT_MAPPED_SIZE)
+        limit = BOOT_MAPPED_SIZE;
+
+    /**
+     * Nothing runs from the identity mapping past the boot code. It shares
+     * the boot page tables with the direct map, so it is dropped before
+     * any of their entries turns global.
+     */
+    for (size_t pde = 0; pde < PDE_INDEX(BOOT_MAPPED_SIZE); pde++)
+        page_directory[pde] = 0;
+    I386::CPU::write_cr3(I386::CPU::read_cr3());
+
+    I386::CPU::cpuid(CPUID_LEAF_FEATURES, &regs);
+    if (regs.edx & CPUID_EDX_PGE)
+        global_flag = PAGE_GLOBAL;
+
+    if (regs.edx & CPUID_EDX_PSE)
+    {
+        /**
+         * Replace the boot page tables by 4 MiB pages. Both translate the
+         * kernel image the same way, so it keeps running across the switch.
+         */
+        I386::CPU::write_cr4(I386::CPU::read_cr4() | CR4_PSE);
+        for (uintptr_t addr = 0; addr < limit; addr += LARGE_PAGE_SIZE)
+            page_directory[PDE_INDEX(KERNEL_VIRTUAL_BASE + addr)] = addr | PAGE_KERNEL | PDE_LARGE | global_flag;
+        I386::CPU::write_cr3(I386::CPU::read_cr3());
+        large_pages = true;
+    }
+    else
+    {
+        // The boot page tables already map the start of physical memory
+        ret = map(KERNEL_VIRTUAL_BASE + BOOT_MAPPED_SIZE, BOOT_MAPPED_SIZE, limit - BOOT_MAPPED_SIZE, PAGE_KERNEL);
+
+        // Make the boot mappings of the kernel global
+        protect(KERNEL_VIRTUAL_BASE, BOOT_MAPPED_SIZE, PAGE_KERNEL);
+    }
+    if (ret == 0)
+        direct_end = limit;
+
+    // Global kernel mappings survive address space switches from now on
+    if (global_flag)
+        I386::CPU::write_cr4(I386::CPU::read_cr4() | CR4_PGE);
+
+    LOG_INFO("paging", "%lu MiB direct mapped with %s pages%s\n", (unsigned long)(direct_end >> 20),
+             large_pages ? "4 MiB" : "4 KiB", global_flag ? ", global" : "");
+    return ret;
+}
+
+/**
+ * Reserve a run of pages in the device memory window
+ *
+ * @param count number of pages
+ * @returns first page index or -1 if no run is free
+ */
+static long ioremap_alloc(size_t count)
+{
+    size_t run = 0;
+
+    for (size_t index = 0; index < IOREMAP_PAGES; index++)
+    {
+        if (ioremap_map[index / 32] & (1u << (index % 32)))
+        {
+            run = 0;
+            continue;
+        }
+
+        if (++run == count)
+        {
+            size_t first = index + 1 - count;
+            for (size_t i = first; i <= index; i++)
+                ioremap_map[i / 32] |= 1u << (i % 32);
+            return first;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Release a run of pages in the device memory window
+ *
+ * @param first first page index
+ * @param count number of pages
+ */
+static void ioremap_free(size_t first, size_t count)
+{
+    for (size_t i = first; i < first + count; i++)
+        ioremap_map[i / 32] &= ~(1u << (i % 32));
+}
+
+void *kernel::Paging::ioremap(uintptr_t phys, size_t size)
+{
+    uintptr_t offset = phys & ~PAGE_ADDR_MASK;
+    size_t count = PFN(PAGE_ALIGN(offset + size));
+
+    if (size == 0 || phys + size < phys)
+        return nullptr;
+    if (phys + size <= direct_end)
+        return phys_to_virt(phys);
+
+    unsigned long irq_flags = kernel::irq_save();
+    long first = ioremap_alloc(count);
+    kernel::irq_restore(irq_flags);
+    if (first < 0)
+        return nullptr;
+
+    uintptr_t virt = IOREMAP_START + ((uintptr_t)first << PAGE_SHIFT);
+    if (map(virt, phys - offset, count << PAGE_SHIFT, PAGE_KERNEL_IO))
+    {
+        iounmap((void *)(virt + offset), size);
+        return nullptr;
+    }
+
+    return (void *)(virt + offset);
+}
+
+void kernel::Paging::iounmap(void *addr, size_t size)
+{
+    uintptr_t virt = (uintptr_t)addr;
+    uintptr_t offset = virt & ~PAGE_ADDR_MASK;
+    size_t count = PFN(PAGE_ALIGN(offset + size));
+
+    // Direct map addresses handed out by `ioremap` stay mapped
+    if (virt < IOREMAP_START || virt >= IOREMAP_END)
+        return;
+
+    unmap(virt - offset, count << PAGE_SHIFT);
+
+    unsigned long irq_flags = kernel::irq_save();
+    ioremap_free(PFN(virt - IOREMAP_START), count);
+    kernel::irq_restore(irq_flags);
+}
@@ -45,6 +45,12 @@
 #define PIC_OCW3_MASK_ESMM 0x40 //01000000
 #define PIC_OCW3_MASK_D7 0x80   //10000000
 
+// Command Word 3 command reading the in-service register on the next status read
+#define PIC_OCW3_READ_ISR 0x0B
+
+/** Lowest priority line of each PIC. Spurious interrupts are raised on it. */
+#define PIC_SPURIOUS_LINE 7
+
 //-----------------------------------------------
 //	Initialization Command 1 control bits
 //-----------------------------------------------
@@ -129,6 +135,11 @@ struct PIC
 static PIC<MASTER_PIC_REG_0, MASTER_PIC_REG_1> m_pic;
 static PIC<SLAVE_PIC_REG_0, SLAVE_PIC_REG_1> s_pic;
 
+/**
+ * Number of spurious interrupts seen on each interrupt line
+ */
+static uint32_t spurious_count[16];
+
 void I386::PIC::setup()
 {
     // initialization control word
@@ -215,14 +226,63 @@ void I386::PIC::unmask(uint8_t n)
 #undef UNMASK
 }
 
+void I386::PIC::disable()
+{
+    m_pic.send_data(0xFF);
+    s_pic.send_data(0xFF);
+}
+
+bool I386::PIC::spurious(uint32_t n)
+{
+    /**
+     * A PIC raises its lowest priority line when the request disappears 
+     * before the interrupt acknowledge cycle. A real interrupt has the
+     * in-service bit of the line set.
+     */
+    if (n == ISR_IRQ0 + PIC_SPURIOUS_LINE)
+    {
+        m_pic.send_cmd(PIC_OCW3_READ_ISR);
+        if (m_pic.get_status() & (1 << PIC_SPURIOUS_LINE))
+        {
+            return false;
+        }
+
+        // Nothing is in service on the master so no EOI is sent
+        spurious_count[PIC_SPURIOUS_LINE]++;
+        return true;
+    }
+
+    if (n == ISR_IRQ0 + 8 + PIC_SPURIOUS_LINE)
+    {
+        s_pic.send_cmd(PIC_OCW3_READ_ISR);
+        if (s_pic.get_status() & (1 << PIC_SPURIOUS_LINE))
+        {
+            return false;
+        }
+
+        // The master saw a real interrupt on the cascade line
+        m_pic.send_cmd(PIC_OCW2_MASK_EOI);
+        spurious_count[8 + PIC_SPURIOUS_LINE]++;
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t I386::PIC::get_spurious(uint8_t n)
+{
+    return n < 16 ? spurious_count[n] : 0;
+}
+
 void I386::PIC::eoi(uint32_t n)
 {
     /** 
      * Check if interrupt is a hardware interrupt. Since any hardware
      * device interrupt is triggered though PIC, the master and slave 
-     * PIC mapped ISR are checked.
+     * PIC mapped ISR are checked. Software interrupts such as system
+     * calls are not acknowledged, or they would end an IRQ in service.
      */
-    if (n >= ISR_IRQ0)
+    if (n >= ISR_IRQ0 && n < ISR_IRQ0 + 16)
     {
         // Always send EOI to master PIC
         m_pic.send_cmd(PIC_OCW2_MASK_EOI);
@@ -3,7 +3,10 @@
 
 #include <kernel/ioport.hpp>
 #include <kernel/isr.hpp>
+#include <kernel/seqlock.hpp>
+#include <kernel/softirq.hpp>
 
+#include <i386/cpu.hpp>
 #include <i386/pit.hpp>
 
 //-----------------------------------------------
@@ -22,6 +25,9 @@
  */
 #define TIMER_DIVISOR (TIMER_HZ / CLOCKS_PER_SEC)
 
+/** Longest one-shot delay in ticks fitting into the 16-bit counter */
+#define PIT_MAX_ONESHOT_TICKS (0xFFFF / TIMER_DIVISOR)
+
 //-----------------------------------------------
 //	Controller Registers
 //-----------------------------------------------
@@ -31,6 +37,24 @@
 #define PIT_REG_COUNTER_2 0x42
 #define PIT_REG_COMMAND 0x43
 
+//-----------------------------------------------
+//	System control port B
+//-----------------------------------------------
+
+#define PIT_REG_PORTB 0x61
+
+#define PIT_PORTB_GATE2 0x01   // counter 2 gate input
+#define PIT_PORTB_SPEAKER 0x02 // speaker data enable
+#define PIT_PORTB_OUT2 0x20    // counter 2 output state
+
+//-----------------------------------------------
+//	TSC calibration
+//-----------------------------------------------
+
+#define PIT_CALIBRATE_MS 10          // calibration period
+#define PIT_CALIBRATE_RUNS 3         // calibration runs, the shortest one is used
+#define PIT_CALIBRATE_LOOPS 0x100000 // polls before giving up on a run
+
 //-----------------------------------------------
 //	Operational Command Bit masks
 //-----------------------------------------------
@@ -67,20 +91,83 @@
 #define PIT_OCW_COUNTER_1 0x40 //01000000
 #define PIT_OCW_COUNTER_2 0x80 //10000000
 
+//! Read-back command latching count and status of counter 0
+#define PIT_READBACK_COUNTER_0 0xC2 //11000010
+
+//! Output pin state in read-back status
+#define PIT_STATUS_OUT 0x80 //10000000
+
+/**
+ * Tick count used for system timer. The 64-bit count is published
+ * through a sequence lock so readers see consistent values.
+ */
+static uint64_t ticks = 0;
+static kernel::SeqLock ticks_lock;
+
+/**
+ * Number of ticks covered by the armed one-shot. Zero while the counter
+ * runs in periodic mode.
+ */
+static volatile uint32_t oneshot_ticks = 0;
+
+/**
+ * PIT clocks elapsed since the last tick boundary when the one-shot was
+ * armed. Keeps ticks in phase across stopped periods.
+ */
+static uint32_t residue = 0;
+
+/**
+ * Initial count of the armed one-shot
+ */
+static uint16_t oneshot_count = 0;
+
+static void program(uint8_t mode, uint16_t count);
+static uint8_t read_counter(uint16_t *count);
+
 /**
- * Tick count used for system timer
+ * Advance the tick count
+ * 
+ * @param n number of elapsed ticks
  */
-static volatile uint32_t ticks = 0;
+static void add_ticks(uint32_t n)
+{
+    unsigned long flags = ticks_lock.write_lock();
+    ticks += n;
+    ticks_lock.write_unlock(flags);
+}
 
 /**
  * Interrupt handler for PIT 
  * 
  * This interrupt is triggered by the PIT counter 0. On each trigger
- * the tick count is increased indicating change in system clock.
+ * the tick count is increased indicating change in system clock and
+ * expired timers are left to the timer softirq. An expired one-shot
+ * accounts for all ticks it covered and restarts the periodic tick.
+ * A periodic tick delivered while the one-shot is armed leaves it armed.
  */
-static void pit_isr(kernel::ISRFrame *const frame)
+static kernel::ISRResult pit_isr(kernel::ISRFrame *const frame, void *ctx)
 {
-    ticks++;
+    uint16_t count;
+
+    /**
+     * A periodic tick raised just before the one-shot was armed is still
+     * delivered afterwards. Only credit the one-shot once its counter has
+     * reached terminal count, otherwise the tick stands for itself and the
+     * residue already counts from its boundary.
+     */
+    if (oneshot_ticks && (read_counter(&count) & PIT_STATUS_OUT))
+    {
+        add_ticks(oneshot_ticks);
+        oneshot_ticks = 0;
+        residue = 0;
+        program(PIT_OCW_MODE_RATEGEN, TIMER_DIVISOR);
+    }
+    else
+    {
+        add_ticks(1);
+    }
+    kernel::SoftIRQ::raise(SOFTIRQ_TIMER);
+    return kernel::IRQ_HANDLED;
 }
 
 /**
@@ -119,23 +206,150 @@ static uint8_t read_data(uint8_t counter)
     return kernel::inb(port);
 }
 
-void I386::PIT::setup()
+/**
+ * Program counter 0
+ * 
+ * @param mode counter mode
+ * @param count initial count, zero counts 65536 clocks
+ */
+static void program(uint8_t mode, uint16_t count)
 {
     // Send operational command
     uint8_t ocw = 0;
-    ocw = (ocw & ~PIT_OCW_MASK_MODE) | PIT_OCW_MODE_RATEGEN;
+    ocw = (ocw & ~PIT_OCW_MASK_MODE) | mode;
     ocw = (ocw & ~PIT_OCW_MASK_RL) | PIT_OCW_RL_DATA;
     ocw = (ocw & ~PIT_OCW_MASK_COUNTER) | PIT_OCW_COUNTER_0;
     send_cmd(ocw);
 
+    // Set initial count
+    send_data(PIT_OCW_COUNTER_0, count & 0xff);
+    send_data(PIT_OCW_COUNTER_0, (count >> 8) & 0xff);
+}
+
+/**
+ * Latch and read status and current count of counter 0
+ * 
+ * @param count pointer to store current count
+ * @returns counter status
+ */
+static uint8_t read_counter(uint16_t *count)
+{
+    send_cmd(PIT_READBACK_COUNTER_0);
+
+    uint8_t status = read_data(PIT_OCW_COUNTER_0);
+    *count = read_data(PIT_OCW_COUNTER_0);
+    *count |= read_data(PIT_OCW_COUNTER_0) << 8;
+    return status;
+}
+
+void I386::PIT::setup()
+{
     // Set frequency rate
-    send_data(TIMER_DIVISOR & 0xff, PIT_OCW_COUNTER_0);
-    send_data((TIMER_DIVISOR >> 8) & 0xff, PIT_OCW_COUNTER_0);
+    program(PIT_OCW_MODE_RATEGEN, TIMER_DIVISOR);
 
     kernel::IVT::register_isr(ISR_TIMER, pit_isr);
 }
 
+uint32_t I386::PIT::set_oneshot(uint32_t delta)
+{
+    uint16_t count;
+
+    if (oneshot_ticks || delta == 0)
+        return 0;
+    if (delta > PIT_MAX_ONESHOT_TICKS)
+        delta = PIT_MAX_ONESHOT_TICKS;
+
+    // Keep the part of the current period already elapsed
+    read_counter(&count);
+    residue = TIMER_DIVISOR - count;
+
+    oneshot_ticks = delta;
+    oneshot_count = delta * TIMER_DIVISOR - residue;
+    program(PIT_OCW_MODE_TERMINALCOUNT, oneshot_count);
+    return delta;
+}
+
+void I386::PIT::set_periodic()
+{
+    uint16_t count;
+
+    if (oneshot_ticks == 0)
+        return;
+
+    // An expired one-shot restarts the tick from its pending interrupt
+    if (read_counter(&count) & PIT_STATUS_OUT)
+        return;
+
+    // Account for full ticks elapsed since the one-shot was armed
+    uint32_t elapsed = residue + oneshot_count - count;
+    add_ticks(elapsed / TIMER_DIVISOR);
+    residue = elapsed % TIMER_DIVISOR;
+    kernel::SoftIRQ::raise(SOFTIRQ_TIMER);
+
+    // Run up to the next tick boundary before restarting the periodic tick
+    oneshot_ticks = 1;
+    oneshot_count = TIMER_DIVISOR - residue;
+    program(PIT_OCW_MODE_TERMINALCOUNT, oneshot_count);
+}
+
 uint32_t I386::PIT::get_ticks()
 {
-    return ticks;
+    return get_ticks64();
+}
+
+uint64_t I386::PIT::get_ticks64()
+{
+    uint64_t value;
+    uint32_t seq;
+
+    do
+    {
+        seq = ticks_lock.read_begin();
+        value = ticks;
+    } while (ticks_lock.read_retry(seq));
+
+    return value;
+}
+
+/**
+ * Time one calibration period of counter 2 with the TSC
+ * 
+ * @returns TSC cycles in the period or 0 if counter 2 never expired
+ */
+static uint64_t time_calibration_period()
+{
+    uint16_t count = TIMER_HZ / (1000 / PIT_CALIBRATE_MS);
+
+    // Open the gate of counter 2 with the speaker disconnected
+    kernel::outb((kernel::inb(PIT_REG_PORTB) & ~PIT_PORTB_SPEAKER) | PIT_PORTB_GATE2, PIT_REG_PORTB);
+
+    // Counter 2 output rises on terminal count
+    send_cmd(PIT_OCW_COUNTER_2 | PIT_OCW_RL_DATA | PIT_OCW_MODE_TERMINALCOUNT);
+    send_data(PIT_OCW_COUNTER_2, count & 0xff);
+    send_data(PIT_OCW_COUNTER_2, (count >> 8) & 0xff);
+
+    uint64_t start = I386::CPU::rdtsc();
+    for (uint32_t i = 0; i < PIT_CALIBRATE_LOOPS; i++)
+    {
+        if (kernel::inb(PIT_REG_PORTB) & PIT_PORTB_OUT2)
+            return I386::CPU::rdtsc() - start;
+    }
+    return 0;
+}
+
+uint32_t I386::PIT::calibrate_tsc()
+{
+    uint64_t best = 0;
+
+    unsigned long flags = kernel::irq_save();
+    for (uint32_t run = 0; run < PIT_CALIBRATE_RUNS; run++)
+    {
+        // Runs stretched by SMIs or virtual CPU preemption only read slower
+        uint64_t cycles = time_calibration_period();
+        if (cycles && (best == 0 || cycles < best))
+            best = cycles;
+    }
+    kernel::irq_restore(flags);
+
+    return best / PIT_CALIBRATE_MS;
 }
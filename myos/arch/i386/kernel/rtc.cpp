@@ -0,0 +1,137 @@
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+
+#include <i386/rtc.hpp>
+
+//-----------------------------------------------
+//	CMOS ports
+//-----------------------------------------------
+
+#define CMOS_REG_INDEX 0x70
+#define CMOS_REG_DATA 0x71
+
+//-----------------------------------------------
+//	RTC registers
+//-----------------------------------------------
+
+#define RTC_SECONDS 0x00
+#define RTC_MINUTES 0x02
+#define RTC_HOURS 0x04
+#define RTC_DAY 0x07
+#define RTC_MONTH 0x08
+#define RTC_YEAR 0x09
+#define RTC_STATUS_A 0x0A
+#define RTC_STATUS_B 0x0B
+
+#define RTC_STATUS_A_UIP 0x80    // update in progress
+#define RTC_STATUS_B_24H 0x02    // 24 hour mode
+#define RTC_STATUS_B_BINARY 0x04 // binary instead of BCD values
+#define RTC_HOURS_PM 0x80        // PM flag in 12 hour mode
+
+/** Years before 70 are taken to be in the 21st century */
+#define RTC_CENTURY_PIVOT 70
+
+/**
+ * RTC date and time registers
+ */
+struct RTCTime
+{
+    uint8_t seconds;
+    uint8_t minutes;
+    uint8_t hours;
+    uint8_t day;
+    uint8_t month;
+    uint8_t year;
+};
+
+static uint8_t cmos_read(uint8_t reg)
+{
+    kernel::outb(reg, CMOS_REG_INDEX);
+    return kernel::inb(CMOS_REG_DATA);
+}
+
+/**
+ * Read the date and time registers once no update is in progress
+ *
+ * @param time pointer to store register values
+ */
+static void read_registers(RTCTime *time)
+{
+    while (cmos_read(RTC_STATUS_A) & RTC_STATUS_A_UIP)
+        kernel::rep_nop();
+
+    time->seconds = cmos_read(RTC_SECONDS);
+    time->minutes = cmos_read(RTC_MINUTES);
+    time->hours = cmos_read(RTC_HOURS);
+    time->day = cmos_read(RTC_DAY);
+    time->month = cmos_read(RTC_MONTH);
+    time->year = cmos_read(RTC_YEAR);
+}
+
+static inline uint8_t bcd_to_bin(uint8_t value)
+{
+    return (value & 0x0F) + (value >> 4) * 10;
+}
+
+/**
+ * Count days from the Unix epoch to a civil date
+ *
+ * @param year full year
+ * @param month month 1 to 12
+ * @param day day of month 1 to 31
+ * @returns days since 1970-01-01
+ */
+static int64_t days_from_civil(int64_t year, uint32_t month, uint32_t day)
+{
+    // Count years from March so the leap day ends the year
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = year - era * 400;
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+uint64_t I386::RTC::read_time()
+{
+    RTCTime time, last;
+
+    unsigned long flags = kernel::irq_save();
+
+    // Read until two reads agree so an update can not tear the values
+    read_registers(&time);
+    do
+    {
+        last = time;
+        read_registers(&time);
+    } while (last.seconds != time.seconds || last.minutes != time.minutes ||
+             last.hours != time.hours || last.day != time.day ||
+             last.month != time.month || last.year != time.year);
+
+    uint8_t status = cmos_read(RTC_STATUS_B);
+
+    kernel::irq_restore(flags);
+
+    bool pm = time.hours & RTC_HOURS_PM;
+    time.hours &= ~RTC_HOURS_PM;
+
+    if (!(status & RTC_STATUS_B_BINARY))
+    {
+        time.seconds = bcd_to_bin(time.seconds);
+        time.minutes = bcd_to_bin(time.minutes);
+        time.hours = bcd_to_bin(time.hours);
+        time.day = bcd_to_bin(time.day);
+        time.month = bcd_to_bin(time.month);
+        time.year = bcd_to_bin(time.year);
+    }
+
+    // 12 hour mode counts 12, 1, ..., 11
+    if (!(status & RTC_STATUS_B_24H))
+        time.hours = (time.hours % 12) + (pm ? 12 : 0);
+
+    int64_t year = time.year + (time.year < RTC_CENTURY_PIVOT ? 2000 : 1900);
+    int64_t days = days_from_civil(year, time.month, time.day);
+
+    return days * 86400 + time.hours * 3600 + time.minutes * 60 + time.seconds;
+}
@@ -1,10 +1,14 @@
-#include <i386/pic.hpp>
+#include <i386/irq.hpp>
 #include <i386/pit.hpp>
 #include <i386/exception.hpp>
+#include <i386/fpu.hpp>
+#include <i386/tsc.hpp>
+#include <i386/syscall.hpp>
 
 #include <kernel/setup.hpp>
 #include <kernel/isr.hpp>
 #include <kernel/ioport.hpp>
+#include <kernel/logging.hpp>
 
 void kernel::arch_setup()
 {
@@ -16,7 +20,6 @@ void kernel::arch_setup()
     IVT::register_isr(4, I386::overflow_trap);
     IVT::register_isr(5, I386::bounds_check_fault);
     IVT::register_isr(6, I386::invalid_opcode_fault);
-    IVT::register_isr(7, I386::no_device_fault);
     IVT::register_isr(8, I386::double_fault_abort);
     IVT::register_isr(10, I386::invalid_tss_fault);
     IVT::register_isr(11, I386::no_segment_fault);
@@ -28,12 +31,27 @@ void kernel::arch_setup()
     IVT::register_isr(18, I386::machine_check_abort);
     IVT::register_isr(19, I386::simd_fpu_fault);
 
-    // Setup PICs for hardware interrupts
-    I386::PIC::setup();
+    // Registering system call trap handler
+    IVT::register_isr(ISR_SYSCALL, I386::syscall_trap);
+
+    // Setup FPU. Without an FPU the device not available fault is fatal.
+    if (I386::FPU::setup())
+    {
+        IVT::register_isr(7, I386::no_device_fault);
+    }
+
+    // Setup interrupt controller for hardware interrupts
+    I386::IRQ::setup();
 
     // Setup PIT
     I386::PIT::setup();
 
+    // Calibrate TSC clock source. Without a TSC time keeping falls back to PIT ticks.
+    if (I386::TSC::setup())
+    {
+        LOG_WARN("tsc", "no usable TSC found\n");
+    }
+
     /** Enable interupts */
     sti();
 }
@@ -0,0 +1,10 @@
+#include <kernel/isr.hpp>
+#include <kernel/syscall.hpp>
+
+#include <i386/syscall.hpp>
+
+kernel::ISRResult I386::syscall_trap(kernel::ISRFrame *const frame, void *ctx)
+{
+    frame->arg.eax = kernel::syscall(frame->arg.eax, frame->arg.ebx, frame->arg.ecx, frame->arg.edx);
+    return kernel::IRQ_HANDLED;
+}
@@ -0,0 +1,46 @@
+#include <stdint.h>
+#include <time.h>
+
+#include <kernel/time.hpp>
+
+#include <i386/cpu.hpp>
+#include <i386/pit.hpp>
+#include <i386/rtc.hpp>
+#include <i386/tsc.hpp>
+
+uint32_t kernel::get_ticks()
+{
+    return I386::PIT::get_ticks();
+}
+
+uint64_t kernel::get_ticks64()
+{
+    return I386::PIT::get_ticks64();
+}
+
+uint64_t kernel::get_cycles()
+{
+    return I386::CPU::rdtsc();
+}
+
+uint64_t kernel::ktime_get_ns()
+{
+    if (I386::TSC::available())
+        return I386::TSC::get_ns();
+    return I386::PIT::get_ticks64() * (NSEC_PER_SEC / CLOCKS_PER_SEC);
+}
+
+uint64_t kernel::read_persistent_clock()
+{
+    return I386::RTC::read_time();
+}
+
+uint32_t kernel::tick_stop(uint32_t delta)
+{
+    return I386::PIT::set_oneshot(delta);
+}
+
+void kernel::tick_restart()
+{
+    I386::PIT::set_periodic();
+}
@@ -0,0 +1,96 @@
+#include <stdint.h>
+
+#include <kernel/logging.hpp>
+
+#include <i386/cpu.hpp>
+#include <i386/pit.hpp>
+#include <i386/tsc.hpp>
+
+/** Nanoseconds in a millisecond, the period of a kHz */
+#define NSEC_PER_MSEC 1000000ULL
+
+/**
+ * Cycles to nanoseconds conversion: ns = cycles * mult >> shift
+ */
+static uint32_t mult = 0;
+static uint32_t shift = 0;
+
+/**
+ * TSC value at calibration, the zero point of the clock
+ */
+static uint64_t base_cycles = 0;
+
+static uint32_t khz = 0;
+static bool is_invariant = false;
+
+/**
+ * Compute the largest shift keeping the conversion multiplier in 32 bits
+ *
+ * @param freq_khz clock frequency in kHz
+ */
+static void calc_mult_shift(uint32_t freq_khz)
+{
+    for (shift = 32; shift > 0; shift--)
+    {
+        uint64_t m = (NSEC_PER_MSEC << shift) / freq_khz;
+        if (m <= 0xFFFFFFFF)
+        {
+            mult = m;
+            return;
+        }
+    }
+    mult = NSEC_PER_MSEC / freq_khz;
+}
+
+int I386::TSC::setup()
+{
+    I386::CPU::CPUIDRegs regs;
+
+    I386::CPU::cpuid(CPUID_LEAF_FEATURES, &regs);
+    if (!(regs.edx & CPUID_EDX_TSC))
+        return -1;
+
+    I386::CPU::cpuid(CPUID_LEAF_EXT_MAX, &regs);
+    if (regs.eax >= CPUID_LEAF_EXT_POWER)
+    {
+        I386::CPU::cpuid(CPUID_LEAF_EXT_POWER, &regs);
+        is_invariant = regs.edx & CPUID_EDX_INVARIANT_TSC;
+    }
+
+    uint32_t freq = I386::PIT::calibrate_tsc();
+    if (freq == 0)
+        return -1;
+
+    calc_mult_shift(freq);
+    base_cycles = I386::CPU::rdtsc();
+    khz = freq;
+
+    LOG_INFO("tsc", "%lu.%03lu MHz%s\n", (unsigned long)(khz / 1000), (unsigned long)(khz % 1000),
+             is_invariant ? "" : ", not invariant");
+    return 0;
+}
+
+bool I386::TSC::available()
+{
+    return khz != 0;
+}
+
+bool I386::TSC::invariant()
+{
+    return is_invariant;
+}
+
+uint32_t I386::TSC::get_khz()
+{
+    return khz;
+}
+
+uint64_t I386::TSC::get_ns()
+{
+    uint64_t cycles = I386::CPU::rdtsc() - base_cycles;
+
+    // 96-bit product of the cycle count and multiplier shifted down
+    uint64_t hi = (cycles >> 32) * mult;
+    uint64_t lo = (cycles & 0xFFFFFFFF) * mult;
+    return (hi << (32 - shift)) + (lo >> shift);
+}
@@ -0,0 +1,363 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/isr.hpp>
+#include <kernel/tty.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/keyboard.hpp>
+
+//-----------------------------------------------
+//	8042 controller registers
+//-----------------------------------------------
+
+#define KBD_REG_DATA 0x60    // data port
+#define KBD_REG_STATUS 0x64  // status register (read)
+#define KBD_REG_COMMAND 0x64 // command register (write)
+
+//-----------------------------------------------
+//	Register bits and commands
+//-----------------------------------------------
+
+#define KBD_STATUS_OBF 0x01 // output buffer full
+#define KBD_STATUS_IBF 0x02 // input buffer full
+#define KBD_STATUS_AUX 0x20 // output buffer holds mouse data
+
+#define KBD_CMD_READ_CONFIG 0x20  // read controller configuration byte
+#define KBD_CMD_WRITE_CONFIG 0x60 // write controller configuration byte
+
+#define KBD_CONFIG_INT 0x01  // first port interrupt enable
+#define KBD_CONFIG_XLAT 0x40 // first port translation to scancode set 1
+
+/** Number of status polls before giving up on the controller */
+#define KBD_TIMEOUT 100000
+
+//-----------------------------------------------
+//	Scancode set 1
+//-----------------------------------------------
+
+#define SC_EXTENDED 0xE0 // prefix of extended keys
+#define SC_PAUSE 0xE1    // prefix of the pause key sequence
+#define SC_RELEASE 0x80  // key release bit
+
+#define SC_ENTER 0x1C
+#define SC_LCTRL 0x1D
+#define SC_LSHIFT 0x2A
+#define SC_SLASH 0x35
+#define SC_RSHIFT 0x36
+#define SC_LALT 0x38
+#define SC_CAPSLOCK 0x3A
+#define SC_NUMLOCK 0x45
+
+/** Number of bytes following the pause key prefix */
+#define SC_PAUSE_LENGTH 5
+
+/** Keypad scancode range affected by num lock */
+#define SC_KEYPAD_FIRST 0x47
+#define SC_KEYPAD_LAST 0x53
+
+//-----------------------------------------------
+//	Modifier state bits
+//-----------------------------------------------
+
+#define MOD_LSHIFT 0x01
+#define MOD_RSHIFT 0x02
+#define MOD_CTRL 0x04
+#define MOD_ALT 0x08
+#define MOD_CAPSLOCK 0x10
+#define MOD_NUMLOCK 0x20
+
+#define ESC "\033"
+
+/**
+ * Scancode ring buffer.
+ *
+ * The interrupt handler is the only producer advancing the head while
+ * the bottom half is the only consumer advancing the tail, so no lock
+ * is needed.
+ */
+static struct
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t overruns;
+    uint8_t data[KEYBOARD_BUFSIZ];
+} ring;
+
+/**
+ * US keyboard layout mapping scancodes to chars without and with shift.
+ * Zero marks keys without a char.
+ */
+static const char keymap[][2] = {
+    {0, 0}, {'\033', '\033'}, {'1', '!'}, {'2', '@'}, {'3', '#'}, {'4', '$'}, {'5', '%'}, {'6', '^'},             // 0x00
+    {'7', '&'}, {'8', '*'}, {'9', '('}, {'0', ')'}, {'-', '_'}, {'=', '+'}, {'\b', '\b'}, {'\t', '\t'},           // 0x08
+    {'q', 'Q'}, {'w', 'W'}, {'e', 'E'}, {'r', 'R'}, {'t', 'T'}, {'y', 'Y'}, {'u', 'U'}, {'i', 'I'},               // 0x10
+    {'o', 'O'}, {'p', 'P'}, {'[', '{'}, {']', '}'}, {'\r', '\r'}, {0, 0}, {'a', 'A'}, {'s', 'S'},                 // 0x18
+    {'d', 'D'}, {'f', 'F'}, {'g', 'G'}, {'h', 'H'}, {'j', 'J'}, {'k', 'K'}, {'l', 'L'}, {';', ':'},               // 0x20
+    {'\'', '"'}, {'`', '~'}, {0, 0}, {'\\', '|'}, {'z', 'Z'}, {'x', 'X'}, {'c', 'C'}, {'v', 'V'},                 // 0x28
+    {'b', 'B'}, {'n', 'N'}, {'m', 'M'}, {',', '<'}, {'.', '>'}, {'/', '?'}, {0, 0}, {'*', '*'},                   // 0x30
+    {0, 0}, {' ', ' '}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0},                                           // 0x38
+    {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {'7', '7'},                                           // 0x40
+    {'8', '8'}, {'9', '9'}, {'-', '-'}, {'4', '4'}, {'5', '5'}, {'6', '6'}, {'+', '+'}, {'1', '1'},               // 0x48
+    {'2', '2'}, {'3', '3'}, {'0', '0'}, {'.', '.'},                                                               // 0x50
+};
+
+/**
+ * Keycodes of the keypad keys with num lock off, shared with the
+ * matching extended navigation keys.
+ */
+static const uint16_t keypad_keycodes[SC_KEYPAD_LAST - SC_KEYPAD_FIRST + 1] = {
+    KEY_HOME, KEY_UP, KEY_PAGE_UP, '-', KEY_LEFT, 0, KEY_RIGHT, '+',
+    KEY_END, KEY_DOWN, KEY_PAGE_DOWN, KEY_INSERT, KEY_DELETE};
+
+/**
+ * ANSI escape sequences sent to the terminal for navigation keycodes
+ */
+static const char *const key_sequences[] = {
+    ESC "[A", ESC "[B", ESC "[D", ESC "[C", ESC "[H",
+    ESC "[F", ESC "[2~", ESC "[3~", ESC "[5~", ESC "[6~"};
+
+/**
+ * Keyboard translation state. Only accessed by the bottom half.
+ */
+static uint8_t modifiers = 0;
+static bool extended = false;
+static uint8_t pause_skip = 0;
+
+/**
+ * Bottom half translating queued scancodes
+ */
+static void keyboard_action(unsigned long data)
+{
+    kernel::Keyboard::process();
+}
+
+static kernel::Tasklet keyboard_tasklet(keyboard_action, 0);
+
+/**
+ * Interrupt handler for keyboard IRQ
+ */
+static kernel::ISRResult keyboard_isr(kernel::ISRFrame *const frame, void *ctx)
+{
+    if (!kernel::Keyboard::handle_interrupt())
+        return kernel::IRQ_NONE;
+
+    keyboard_tasklet.schedule();
+    return kernel::IRQ_HANDLED;
+}
+
+/**
+ * Wait for controller status bits.
+ *
+ * @param mask status bits to check
+ * @param value expected value of status bits
+ * @returns 0 on success and -1 on timeout
+ */
+static int wait_status(uint8_t mask, uint8_t value)
+{
+    for (size_t i = 0; i < KBD_TIMEOUT; i++)
+    {
+        if ((kernel::inb(KBD_REG_STATUS) & mask) == value)
+            return 0;
+        kernel::rep_nop();
+    }
+    return -1;
+}
+
+int kernel::Keyboard::init()
+{
+    ring.head = ring.tail = 0;
+    ring.overruns = 0;
+
+    // Discard stale bytes left in the controller output buffer
+    for (size_t i = 0; i < KEYBOARD_BUFSIZ && (kernel::inb(KBD_REG_STATUS) & KBD_STATUS_OBF); i++)
+        (void)kernel::inb(KBD_REG_DATA);
+
+    // Enable keyboard interrupt and translation to scancode set 1
+    if (wait_status(KBD_STATUS_IBF, 0))
+        return -1;
+    kernel::outb(KBD_CMD_READ_CONFIG, KBD_REG_COMMAND);
+    if (wait_status(KBD_STATUS_OBF, KBD_STATUS_OBF))
+        return -1;
+    uint8_t config = kernel::inb(KBD_REG_DATA);
+
+    kernel::IVT::register_isr(ISR_KEYBOARD, keyboard_isr);
+
+    if (wait_status(KBD_STATUS_IBF, 0))
+        return -1;
+    kernel::outb(KBD_CMD_WRITE_CONFIG, KBD_REG_COMMAND);
+    if (wait_status(KBD_STATUS_IBF, 0))
+        return -1;
+    kernel::outb(config | KBD_CONFIG_INT | KBD_CONFIG_XLAT, KBD_REG_DATA);
+
+    return 0;
+}
+
+bool kernel::Keyboard::handle_interrupt()
+{
+    bool handled = false;
+    uint8_t status;
+
+    while ((status = kernel::inb(KBD_REG_STATUS)) & KBD_STATUS_OBF)
+    {
+        handled = true;
+        uint8_t scancode = kernel::inb(KBD_REG_DATA);
+
+        // Mouse data is not handled here
+        if (status & KBD_STATUS_AUX)
+            continue;
+
+        uint32_t head = ring.head;
+        if (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) == KEYBOARD_BUFSIZ)
+        {
+            ring.overruns++;
+            continue;
+        }
+        ring.data[head & (KEYBOARD_BUFSIZ - 1)] = scancode;
+        __atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    return handled;
+}
+
+/**
+ * Translate a scancode to a keycode updating the modifier state.
+ *
+ * @param scancode scancode set 1 byte
+ * @returns keycode of pressed key or 0 if no key is pressed
+ */
+static uint16_t translate(uint8_t scancode)
+{
+    if (pause_skip)
+    {
+        pause_skip--;
+        return 0;
+    }
+    if (scancode == SC_PAUSE)
+    {
+        pause_skip = SC_PAUSE_LENGTH;
+        return 0;
+    }
+    if (scancode == SC_EXTENDED)
+    {
+        extended = true;
+        return 0;
+    }
+
+    const bool release = scancode & SC_RELEASE;
+    const bool ext = extended;
+    uint8_t code = scancode & ~SC_RELEASE;
+    uint8_t modifier = 0;
+
+    extended = false;
+
+    switch (code)
+    {
+    case SC_LSHIFT:
+        // Extended shift codes are faked by the controller around other keys
+        modifier = ext ? 0 : MOD_LSHIFT;
+        break;
+    case SC_RSHIFT:
+        modifier = ext ? 0 : MOD_RSHIFT;
+        break;
+    case SC_LCTRL:
+        modifier = MOD_CTRL;
+        break;
+    case SC_LALT:
+        modifier = MOD_ALT;
+        break;
+    case SC_CAPSLOCK:
+        if (!release)
+            modifiers ^= MOD_CAPSLOCK;
+        return 0;
+    case SC_NUMLOCK:
+        if (!release)
+            modifiers ^= MOD_NUMLOCK;
+        return 0;
+    }
+
+    if (modifier)
+    {
+        if (release)
+            modifiers &= ~modifier;
+        else
+            modifiers |= modifier;
+        return 0;
+    }
+    if (release || code >= sizeof(keymap) / sizeof(keymap[0]))
+        return 0;
+
+    // Navigation keys and the keypad with num lock off
+    if (code >= SC_KEYPAD_FIRST && code <= SC_KEYPAD_LAST)
+    {
+        uint16_t keycode = keypad_keycodes[code - SC_KEYPAD_FIRST];
+        if (ext || (!(modifiers & MOD_NUMLOCK) && keycode >= KEY_UP))
+            return keycode;
+    }
+
+    // Keypad divide and enter share their scancodes with the main keys.
+    // Other extended keys such as media keys are ignored.
+    if (ext && code != SC_ENTER && code != SC_SLASH)
+        return 0;
+
+    const bool shift = modifiers & (MOD_LSHIFT | MOD_RSHIFT);
+    char c = ext ? keymap[code][0] : keymap[code][shift];
+    if (c >= 'a' && c <= 'z' && (modifiers & MOD_CAPSLOCK))
+        c = keymap[code][!shift];
+
+    return (uint8_t)c;
+}
+
+size_t kernel::Keyboard::process()
+{
+    uint32_t tail = ring.tail;
+    uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    char input[16];
+    size_t n = 0;
+    size_t count = head - tail;
+
+    for (; tail != head; tail++)
+    {
+        uint16_t keycode = translate(ring.data[tail & (KEYBOARD_BUFSIZ - 1)]);
+        if (keycode == 0)
+            continue;
+
+        // Make room for the longest input sequence of a key
+        if (n > sizeof(input) - 5)
+        {
+            kernel::ttys[TTY_CONSOLE].receive(input, n);
+            n = 0;
+        }
+
+        if (keycode >= KEY_UP)
+        {
+            for (const char *s = key_sequences[keycode - KEY_UP]; *s; s++)
+                input[n++] = *s;
+            continue;
+        }
+
+        char c = (char)keycode;
+        if (modifiers & MOD_CTRL)
+        {
+            // Control chars for letters and @[\]^_
+            if (c >= 'a' && c <= 'z')
+                c -= 'a' - 'A';
+            if (c >= '@' && c <= '_')
+                c &= 0x1f;
+        }
+        if (modifiers & MOD_ALT)
+            input[n++] = '\033';
+        input[n++] = c;
+    }
+    __atomic_store_n(&ring.tail, tail, __ATOMIC_RELEASE);
+
+    if (n)
+        kernel::ttys[TTY_CONSOLE].receive(input, n);
+
+    return count;
+}
+
+uint32_t kernel::Keyboard::get_overruns()
+{
+    return ring.overruns;
+}
@@ -0,0 +1,215 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/isr.hpp>
+#include <kernel/serial.hpp>
+
+kernel::Serial kernel::serial1;
+kernel::Serial kernel::serial2;
+
+/** UART input clock divided by 16 */
+#define SERIAL_CLOCK 115200
+
+/** Size of hardware transmit FIFO */
+#define SERIAL_FIFO_SIZE 16
+
+//-----------------------------------------------
+//	UART register offsets from base port
+//-----------------------------------------------
+
+#define SERIAL_REG_DATA 0 // receive buffer / transmit holding (DLAB=0)
+#define SERIAL_REG_IER 1  // interrupt enable (DLAB=0)
+#define SERIAL_REG_DLL 0  // divisor latch low byte (DLAB=1)
+#define SERIAL_REG_DLH 1  // divisor latch high byte (DLAB=1)
+#define SERIAL_REG_IIR 2  // interrupt identification (read)
+#define SERIAL_REG_FCR 2  // FIFO control (write)
+#define SERIAL_REG_LCR 3  // line control
+#define SERIAL_REG_MCR 4  // modem control
+#define SERIAL_REG_LSR 5  // line status
+#define SERIAL_REG_MSR 6  // modem status
+
+//-----------------------------------------------
+//	Register bits
+//-----------------------------------------------
+
+#define SERIAL_IER_RDA 0x01  // received data available
+#define SERIAL_IER_THRE 0x02 // transmitter holding register empty
+
+#define SERIAL_IIR_NONE 0x01    // no interrupt pending
+#define SERIAL_IIR_ID_MASK 0x0E // interrupt identification
+#define SERIAL_IIR_MSR 0x00     // modem status changed
+#define SERIAL_IIR_THRE 0x02    // transmitter holding register empty
+#define SERIAL_IIR_RDA 0x04     // received data available
+#define SERIAL_IIR_LSR 0x06     // line status changed
+#define SERIAL_IIR_TIMEOUT 0x0C // character timeout
+
+#define SERIAL_FCR_ENABLE 0x01    // enable FIFOs
+#define SERIAL_FCR_CLEAR_RX 0x02  // clear receive FIFO
+#define SERIAL_FCR_CLEAR_TX 0x04  // clear transmit FIFO
+#define SERIAL_FCR_TRIGGER_14 0xC0 // receive interrupt at 14 bytes
+
+#define SERIAL_LCR_8N1 0x03 // 8 data bits, no parity, 1 stop bit
+#define SERIAL_LCR_DLAB 0x80 // divisor latch access
+
+#define SERIAL_MCR_DTR 0x01      // data terminal ready
+#define SERIAL_MCR_RTS 0x02      // request to send
+#define SERIAL_MCR_OUT2 0x08     // gates UART interrupt to PIC
+#define SERIAL_MCR_LOOPBACK 0x10 // loopback test mode
+
+#define SERIAL_LSR_DR 0x01   // data ready
+#define SERIAL_LSR_THRE 0x20 // transmitter holding register empty
+
+/**
+ * Interrupt handler for serial ports
+ * 
+ * @param frame pointer to ISR stack frame
+ * @param ctx pointer to serial port
+ */
+static kernel::ISRResult serial_isr(kernel::ISRFrame *const frame, void *ctx)
+{
+    return ((kernel::Serial *)ctx)->handle_interrupt() ? kernel::IRQ_HANDLED : kernel::IRQ_NONE;
+}
+
+int kernel::Serial::init(uint16_t port, uint32_t baud)
+{
+    const uint16_t divisor = SERIAL_CLOCK / baud;
+
+    this->port = port;
+    present = false;
+    ier = 0;
+    tx_head = tx_tail = 0;
+    overruns = 0;
+
+    kernel::outb(0, port + SERIAL_REG_IER);
+    kernel::outb(SERIAL_LCR_DLAB, port + SERIAL_REG_LCR);
+    kernel::outb(divisor & 0xff, port + SERIAL_REG_DLL);
+    kernel::outb(divisor >> 8, port + SERIAL_REG_DLH);
+    kernel::outb(SERIAL_LCR_8N1, port + SERIAL_REG_LCR);
+    kernel::outb(SERIAL_FCR_ENABLE | SERIAL_FCR_CLEAR_RX | SERIAL_FCR_CLEAR_TX | SERIAL_FCR_TRIGGER_14,
+                 port + SERIAL_REG_FCR);
+
+    // Check the UART echoes a byte in loopback mode
+    kernel::outb(SERIAL_MCR_LOOPBACK | SERIAL_MCR_RTS, port + SERIAL_REG_MCR);
+    kernel::outb(0xAE, port + SERIAL_REG_DATA);
+    if (kernel::inb(port + SERIAL_REG_DATA) != 0xAE)
+    {
+        kernel::outb(0, port + SERIAL_REG_MCR);
+        return -1;
+    }
+
+    kernel::outb(SERIAL_MCR_DTR | SERIAL_MCR_RTS | SERIAL_MCR_OUT2, port + SERIAL_REG_MCR);
+    present = true;
+
+    kernel::IVT::register_isr(port == SERIAL_COM1 ? ISR_SERIAL1 : ISR_SERIAL2, serial_isr, this);
+
+    return 0;
+}
+
+void kernel::Serial::fill_fifo()
+{
+    for (size_t n = 0; n < SERIAL_FIFO_SIZE && tx_tail != tx_head; n++)
+    {
+        kernel::outb(tx_buffer[tx_tail & (SERIAL_TX_BUFSIZ - 1)], port + SERIAL_REG_DATA);
+        tx_tail++;
+    }
+
+    uint8_t new_ier = tx_tail != tx_head ? ier | SERIAL_IER_THRE : ier & ~SERIAL_IER_THRE;
+    if (new_ier != ier)
+    {
+        ier = new_ier;
+        kernel::outb(ier, port + SERIAL_REG_IER);
+    }
+}
+
+int kernel::Serial::write(const char *buffer, size_t n)
+{
+    if (!present)
+        return 0;
+
+    unsigned long flags = kernel::irq_save();
+
+    size_t room = SERIAL_TX_BUFSIZ - (tx_head - tx_tail);
+    if (n > room)
+    {
+        overruns += n - room;
+        n = room;
+    }
+    for (size_t i = 0; i < n; i++)
+        tx_buffer[(tx_head + i) & (SERIAL_TX_BUFSIZ - 1)] = buffer[i];
+    tx_head += n;
+
+    /**
+     * Start transmission if the transmitter is idle. Otherwise the THRE 
+     * interrupt picks up the queued chars once the FIFO drains.
+     */
+    if (!(ier & SERIAL_IER_THRE))
+    {
+        if (kernel::inb(port + SERIAL_REG_LSR) & SERIAL_LSR_THRE)
+        {
+            fill_fifo();
+        }
+        else
+        {
+            ier |= SERIAL_IER_THRE;
+            kernel::outb(ier, port + SERIAL_REG_IER);
+        }
+    }
+
+    kernel::irq_restore(flags);
+
+    return n;
+}
+
+void kernel::Serial::sync()
+{
+    if (!present)
+        return;
+
+    unsigned long flags = kernel::irq_save();
+
+    while (tx_tail != tx_head)
+    {
+        while (!(kernel::inb(port + SERIAL_REG_LSR) & SERIAL_LSR_THRE))
+            kernel::rep_nop();
+        fill_fifo();
+    }
+
+    kernel::irq_restore(flags);
+}
+
+bool kernel::Serial::handle_interrupt()
+{
+    bool handled = false;
+    uint8_t iir;
+
+    while (!((iir = kernel::inb(port + SERIAL_REG_IIR)) & SERIAL_IIR_NONE))
+    {
+        handled = true;
+        switch (iir & SERIAL_IIR_ID_MASK)
+        {
+        case SERIAL_IIR_THRE:
+            fill_fifo();
+            break;
+        case SERIAL_IIR_RDA:
+        case SERIAL_IIR_TIMEOUT:
+            // Input is not used yet. Drain it to clear the interrupt.
+            while (kernel::inb(port + SERIAL_REG_LSR) & SERIAL_LSR_DR)
+                (void)kernel::inb(port + SERIAL_REG_DATA);
+            break;
+        case SERIAL_IIR_LSR:
+            (void)kernel::inb(port + SERIAL_REG_LSR);
+            break;
+        case SERIAL_IIR_MSR:
+            (void)kernel::inb(port + SERIAL_REG_MSR);
+            break;
+        }
+    }
+
+    return handled;
+}
+
+void kernel::Serial::sink(void *ctx, const char *s, size_t n)
+{
+    ((kernel::Serial *)ctx)->write(s, n);
+}
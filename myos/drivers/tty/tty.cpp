@@ -2,15 +2,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <kernel/ioport.hpp>
 #include <kernel/console.hpp>
+#include <kernel/serial.hpp>
 #include <kernel/tty.hpp>
 
-kernel::TTY kernel::tty;
+kernel::TTY kernel::ttys[NR_TTY];
 
 static void attr_init(struct termios *attr)
 {
     attr->c_iflag = BRKINT | ICRNL;
-    attr->c_oflag = 0;
+    attr->c_oflag = OPOST | ONLCR;
     attr->c_cflag = 0;
     attr->c_lflag = ECHO | ECHOE | ECHOK | ECHONL | ICANON | ISIG;
     attr->c_cc[VEOF] = 0x04;   /* ASCII EOT */
@@ -25,31 +27,266 @@ static void attr_init(struct termios *attr)
     attr->c_cc[VTIME] = 0x00;
 }
 
+/**
+ * Device write routines of the system console devices
+ */
+static int console_write(void *device, const char *buffer, size_t n)
+{
+    return ((kernel::Console *)device)->write(buffer, n);
+}
+
+static int serial_write(void *device, const char *buffer, size_t n)
+{
+    return ((kernel::Serial *)device)->write(buffer, n);
+}
+
 void kernel::TTY::init()
 {
     buffer[0] = 0;
-    read_pos = 0;
     write_pos = 0;
+    dev_write = nullptr;
+    device = nullptr;
+    input_head = input_tail = 0;
+    output_head = output_tail = 0;
 
     attr_init(&attr);
 }
 
-int kernel::TTY::putc(int c)
+void kernel::TTY::attach(kernel::tty_write_t dev_write, void *device)
 {
-    /** TODO: Multi-console suport implementation logic */
-    kernel::console.putchar(c);
-    return 1;
+    unsigned long flags = kernel::irq_save();
+
+    this->dev_write = dev_write;
+    this->device = device;
+
+    kernel::irq_restore(flags);
 }
 
-int kernel::TTY::write(const char *buffer, size_t n)
+void kernel::TTY::get_attr(struct termios *attr)
 {
-    size_t i;
+    *attr = this->attr;
+}
+
+void kernel::TTY::set_attr(const struct termios *attr)
+{
+    unsigned long flags = kernel::irq_save();
+
+    this->attr = *attr;
+
+    kernel::irq_restore(flags);
+}
+
+size_t kernel::TTY::queue_output(const char *s, size_t n)
+{
+    const bool onlcr = (attr.c_oflag & (OPOST | ONLCR)) == (OPOST | ONLCR);
+    size_t i = 0;
 
-    for (i = 0; i < n; i++)
+    while (i < n)
     {
-        if (putc(((const unsigned char *)buffer)[i]) < 0)
+        // Copy the run of chars needing no output processing
+        size_t run = 0;
+        while (i + run < n && !(onlcr && s[i + run] == '\n'))
+            run++;
+
+        size_t room = TTY_BUFSIZ - (output_head - output_tail);
+        if (run > room)
+            run = room;
+        for (size_t k = 0; k < run; k++)
+            output[(output_head + k) & (TTY_BUFSIZ - 1)] = s[i + k];
+        output_head += run;
+        i += run;
+
+        if (i == n || room == run)
             break;
+
+        // Map NL to CR-NL
+        if (room - run < 2)
+            break;
+        output[output_head++ & (TTY_BUFSIZ - 1)] = '\r';
+        output[output_head++ & (TTY_BUFSIZ - 1)] = '\n';
+        i++;
     }
 
     return i;
 }
+
+void kernel::TTY::flush_output()
+{
+    if (dev_write == nullptr)
+    {
+        // Discard output of terminals without a device
+        output_tail = output_head;
+        return;
+    }
+
+    while (output_tail != output_head)
+    {
+        // Write the contiguous span up to the queue wrap around
+        size_t start = output_tail & (TTY_BUFSIZ - 1);
+        size_t span = output_head - output_tail;
+        if (span > TTY_BUFSIZ - start)
+            span = TTY_BUFSIZ - start;
+
+        int written = dev_write(device, &output[start], span);
+        if (written <= 0)
+            break;
+        output_tail += written;
+        if ((size_t)written < span)
+            break;
+    }
+}
+
+int kernel::TTY::putc(int c)
+{
+    char ch = (char)c;
+    return write(&ch, 1);
+}
+
+int kernel::TTY::write(const char *buffer, size_t n)
+{
+    unsigned long flags = kernel::irq_save();
+
+    size_t queued = queue_output(buffer, n);
+    flush_output();
+
+    kernel::irq_restore(flags);
+
+    return queued;
+}
+
+void kernel::TTY::flush()
+{
+    unsigned long flags = kernel::irq_save();
+
+    flush_output();
+
+    kernel::irq_restore(flags);
+}
+
+void kernel::TTY::queue_input(const char *s, size_t n)
+{
+    size_t room = TTY_BUFSIZ - (input_head - input_tail);
+    if (n > room)
+        n = room;
+    for (size_t i = 0; i < n; i++)
+        input[(input_head + i) & (TTY_BUFSIZ - 1)] = s[i];
+    input_head += n;
+}
+
+void kernel::TTY::echo(char c)
+{
+    if ((attr.c_lflag & ECHO) || (c == '\n' && (attr.c_lflag & ECHONL) && (attr.c_lflag & ICANON)))
+        queue_output(&c, 1);
+}
+
+void kernel::TTY::receive(const char *buffer, size_t n)
+{
+    unsigned long flags = kernel::irq_save();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        char c = buffer[i];
+
+        // Input processing
+        if (attr.c_iflag & ISTRIP)
+            c &= 0x7f;
+        if (c == '\r')
+        {
+            if (attr.c_iflag & IGNCR)
+                continue;
+            if (attr.c_iflag & ICRNL)
+                c = '\n';
+        }
+        else if (c == '\n' && (attr.c_iflag & INLCR))
+        {
+            c = '\r';
+        }
+
+        // Signal chars discard the pending line. There are no processes to signal yet.
+        if ((attr.c_lflag & ISIG) && c && (c == attr.c_cc[VINTR] || c == attr.c_cc[VQUIT]))
+        {
+            write_pos = 0;
+            if (attr.c_lflag & ECHO)
+            {
+                // Echo the control char received in caret notation
+                const char caret[3] = {'^', (char)(c ^ 0x40), '\n'};
+                queue_output(caret, 3);
+            }
+            continue;
+        }
+
+        if (!(attr.c_lflag & ICANON))
+        {
+            queue_input(&c, 1);
+            echo(c);
+            continue;
+        }
+
+        // Canonical mode line editing
+        if (c == attr.c_cc[VERASE] || c == 0x7f)
+        {
+            if (write_pos > 0)
+            {
+                write_pos--;
+                if ((attr.c_lflag & ECHO) && (attr.c_lflag & ECHOE))
+                    queue_output("\b \b", 3);
+            }
+        }
+        else if (c && c == attr.c_cc[VKILL])
+        {
+            write_pos = 0;
+            if ((attr.c_lflag & ECHO) && (attr.c_lflag & ECHOK))
+                queue_output("\n", 1);
+        }
+        else if (c && c == attr.c_cc[VEOF])
+        {
+            // End of file makes the pending line available without a terminator
+            queue_input(this->buffer, write_pos);
+            write_pos = 0;
+        }
+        else if (c == '\n' || (c && c == attr.c_cc[VEOL]))
+        {
+            this->buffer[write_pos++] = c;
+            queue_input(this->buffer, write_pos);
+            write_pos = 0;
+            echo(c);
+        }
+        else if (write_pos < MAX_CANON - 1)
+        {
+            this->buffer[write_pos++] = c;
+            echo(c);
+        }
+    }
+    flush_output();
+
+    kernel::irq_restore(flags);
+}
+
+int kernel::TTY::read(char *buffer, size_t n)
+{
+    unsigned long flags = kernel::irq_save();
+
+    size_t available = input_head - input_tail;
+    if (n > available)
+        n = available;
+    for (size_t i = 0; i < n; i++)
+        buffer[i] = input[(input_tail + i) & (TTY_BUFSIZ - 1)];
+    input_tail += n;
+
+    kernel::irq_restore(flags);
+
+    return n;
+}
+
+void kernel::tty_init()
+{
+    ttys[TTY_CONSOLE].attach(console_write, &kernel::console);
+    if (kernel::serial1.is_present())
+        ttys[TTY_SERIAL].attach(serial_write, &kernel::serial1);
+}
+
+void kernel::tty_flush()
+{
+    for (size_t i = 0; i < NR_TTY; i++)
+        ttys[i].flush();
+}
@@ -8,6 +8,20 @@
 
 #include <stdint.h>
 
+/**
+ * Multiboot info flags indicating valid fields of the info structure.
+ */
+#define MULTIBOOT_INFO_MEMORY 0x00000001  /**< memory_lower and memory_upper */
+#define MULTIBOOT_INFO_BOOTDEV 0x00000002 /**< boot_device */
+#define MULTIBOOT_INFO_CMDLINE 0x00000004 /**< cmdline */
+#define MULTIBOOT_INFO_MODS 0x00000008    /**< mods_count and mods_addr */
+#define MULTIBOOT_INFO_MEM_MAP 0x00000040 /**< mmap_length and mmap_addr */
+
+/**
+ * Memory map region types.
+ */
+#define MULTIBOOT_MEMORY_AVAILABLE 1 /**< usable RAM */
+
 namespace boot
 {
 /** 
@@ -39,6 +53,28 @@ struct MultibootInfo
     uint32_t vbe_interface_addr;
     uint16_t vbe_interface_len;
 };
+
+/**
+ * Memory map entry. Entries are `size` plus 4 bytes apart.
+ */
+struct __attribute__((packed)) MultibootMmapEntry
+{
+    uint32_t size; /**< Size of the entry not counting this field */
+    uint64_t addr; /**< Start address of the region */
+    uint64_t len;  /**< Length of the region in bytes */
+    uint32_t type; /**< Region type */
+};
+
+/**
+ * Boot module
+ */
+struct MultibootModule
+{
+    uint32_t mod_start; /**< Start address of the module */
+    uint32_t mod_end;   /**< Address past the module */
+    uint32_t string;    /**< Module command line */
+    uint32_t reserved;
+};
 } // namespace boot
 
 #endif /* ARCH_I386_MULTIBOOT_HPP */
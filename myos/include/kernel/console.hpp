@@ -41,15 +41,83 @@ private:
     size_t row;
     size_t column;
     uint8_t color;
-    uint16_t *buffer;
+    uint16_t *buffer;   /**< Display memory of the console device */
+    size_t buffer_size; /**< Number of character cells in display memory */
+    size_t origin;      /**< Display memory offset of the first visible cell */
+    size_t hw_origin;   /**< Screen start address last programmed in device */
+    size_t hw_cursor;   /**< Cursor location last programmed in device */
 
     /**
-    * Update postion of cursor to the given coordinates.
+     * RAM backed copy of the visible screen. All writes land here and are
+     * copied to display memory by `flush`.
+     */
+    uint16_t shadow[VGA_HEIGHT * VGA_WIDTH];
+
+    /**
+     * Dirty span of each screen line in the shadow buffer. A line is clean
+     * when its start is not less than its end.
+     */
+    uint8_t dirty_start[VGA_HEIGHT];
+    uint8_t dirty_end[VGA_HEIGHT];
+
+    /**
+    * Update postion of cursor in display memory.
     * 
-    * @param column column number of the cursor
-    * @param row row number of the cursor
+    * @param location offset of the cursor cell in display memory
     */
-    void update_cursor(uint16_t column, uint16_t row);
+    void __arch update_cursor(uint16_t location);
+
+    /**
+     * Update the display memory offset shown at the top left corner of 
+     * the screen.
+     * 
+     * @param location offset of the first visible cell in display memory
+     */
+    void __arch update_origin(uint16_t location);
+
+    /**
+     * Mark a span of a screen line as modified.
+     * 
+     * @param row screen line number
+     * @param start first modified column
+     * @param end one past the last modified column
+     */
+    void mark_dirty(size_t row, size_t start, size_t end);
+
+    /**
+     * Scroll screen contents up by one line.
+     */
+    void scroll();
+
+    /**
+     * Move to the start of the next line, scrolling if needed.
+     */
+    void newline();
+
+    /**
+     * Write a char in the shadow buffer without flushing it. Control 
+     * chars move the cursor instead of displaying a glyph.
+     * 
+     * @param c char to write
+     */
+    void put(unsigned char c);
+
+    /**
+     * Write a buffer of chars in the shadow buffer without flushing it.
+     * 
+     * @param s pointer to the first char
+     * @param n number of chars to write
+     */
+    void put(const char *s, size_t n);
+
+    /**
+     * Formatter sink writing to the shadow buffer.
+     * 
+     * @param ctx pointer to console
+     * @param s pointer to the first char
+     * @param n number of chars to write
+     */
+    static void sink(void *ctx, const char *s, size_t n);
 
 public:
     /**
@@ -87,6 +155,12 @@ public:
      */
     void gotoxy(size_t column, size_t row);
 
+    /**
+     * Copy modified spans of the shadow buffer to display memory and
+     * update the screen start address and cursor if they have moved.
+     */
+    void flush();
+
     /**
      * Display a char on console
      * 
@@ -95,6 +169,18 @@ public:
      */
     int putchar(int c);
 
+    /**
+     * Display a buffer of chars on console.
+     * 
+     * Runs of printable chars are copied to the screen with the current
+     * color and the cursor is updated once per call.
+     * 
+     * @param s pointer to the first char
+     * @param n number of chars to display
+     * @returns number of char displayed
+     */
+    int write(const char *s, size_t n);
+
     /**
     * Display a formated string on consol with 
     * variable arguments
@@ -112,7 +198,7 @@ public:
      * @param ... format options
      * @returns number of char displayed
      */
-    int printf(const char *s, ...);
+    int printf(const char *s, ...) __attribute__((format(printf, 2, 3)));
 };
 
 /** Root console used by kernel for system logs **/
@@ -0,0 +1,77 @@
+/**
+ * Freestanding formatted output.
+ * 
+ * The formatter streams its output into a sink callback as it parses the 
+ * format string. It uses no intermediate output buffer, no heap and no 
+ * global state, so it is safe to use from any context.
+ * 
+ * Supported conversions are `%d %i %u %x %X %o %p %s %c %%` with the `-`, 
+ * `0`, `+`, space and `#` flags, field width, precision and the `hh`, `h`, 
+ * `l`, `ll` and `z` length modifiers.
+ */
+
+#ifndef KERNEL_FORMAT_HPP
+#define KERNEL_FORMAT_HPP
+
+#include <stddef.h>
+#include <stdarg.h>
+
+namespace kernel
+{
+/**
+ * Format sink function pointer typedef
+ * 
+ * @param ctx sink context passed to the formatter
+ * @param s pointer to first char of output
+ * @param n number of chars of output
+ */
+typedef void (*format_sink_t)(void *ctx, const char *s, size_t n);
+
+/**
+ * Format a string with variable arguments into a sink.
+ * 
+ * @param sink sink receiving the formatted output
+ * @param ctx sink context
+ * @param fmt format string
+ * @param args additional arguments
+ * @returns number of chars written to sink
+ */
+int vformat(format_sink_t sink, void *ctx, const char *fmt, va_list args);
+
+/**
+ * Format a string into a sink.
+ * 
+ * @param sink sink receiving the formatted output
+ * @param ctx sink context
+ * @param fmt format string
+ * @returns number of chars written to sink
+ */
+int format(format_sink_t sink, void *ctx, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * Format a string with variable arguments into a buffer.
+ * 
+ * The output is truncated to fit the buffer and always null terminated
+ * unless the buffer size is zero. 
+ * 
+ * @param buf output buffer or nullptr to only measure the output
+ * @param size size of output buffer
+ * @param fmt format string
+ * @param args additional arguments
+ * @returns length of the complete output excluding the null terminator
+ */
+int vsnformat(char *buf, size_t size, const char *fmt, va_list args);
+
+/**
+ * Format a string into a buffer.
+ * 
+ * @param buf output buffer or nullptr to only measure the output
+ * @param size size of output buffer
+ * @param fmt format string
+ * @returns length of the complete output excluding the null terminator
+ */
+int snformat(char *buf, size_t size, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+} // namespace kernel
+
+#endif /* KERNEL_FORMAT_HPP */
@@ -0,0 +1,149 @@
+/**
+ * Physical page frame allocator.
+ *
+ * Usable RAM from the boot loader memory map is managed by a binary buddy
+ * allocator. Free memory is kept in blocks of 2^order frames for orders 0
+ * to `FRAME_MAX_ORDER`, and a freed block is merged with its free buddy
+ * into a block of the next order. The kernel image, boot modules and boot
+ * information are never handed out. Only memory reachable through the
+ * kernel direct map is managed.
+ *
+ * Single frames are served from a small hot frame list in front of the
+ * buddy allocator. Recently freed, cache warm frames are reused first and
+ * the free lists are only touched in batches.
+ */
+
+#ifndef KERNEL_FRAME_HPP
+#define KERNEL_FRAME_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <arch/page.hpp>
+#include <boot/multiboot.hpp>
+#include <kernel/format.hpp>
+
+/** Largest block order, blocks of 4 MiB */
+#define FRAME_MAX_ORDER 10
+
+namespace kernel
+{
+/**
+ * Frame allocator statistics
+ */
+struct FrameStats
+{
+    size_t nr_total;                       // usable frames at boot
+    size_t nr_free;                        // free frames including hot frames
+    size_t nr_hot;                         // frames in the hot frame list
+    size_t nr_blocks[FRAME_MAX_ORDER + 1]; // free blocks of each order
+    uint32_t hot_hits;                     // single frames served from the hot list
+    uint32_t allocs;                       // blocks allocated from the free lists
+    uint32_t frees;                        // blocks returned to the free lists
+    uint32_t failures;                     // allocations failed for lack of memory
+};
+
+namespace PageFrame
+{
+    /**
+     * Initialize the frame allocator from the multiboot memory map.
+     *
+     * @param multiboot_info multiboot information
+     * @returns 0 on success and -1 if no memory map is available
+     */
+    int init(boot::MultibootInfo *multiboot_info);
+
+    /**
+     * Allocate a frame. Can be called from any context.
+     *
+     * @returns physical address of the frame or 0 if out of memory
+     */
+    uintptr_t alloc();
+
+    /**
+     * Free a frame allocated by `alloc`. Can be called from any context.
+     *
+     * @param addr physical address of the frame
+     */
+    void free(uintptr_t addr);
+
+    /**
+     * Allocate a block of 2^order frames aligned on its size.
+     *
+     * @param order block order
+     * @returns physical address of the block or 0 if out of memory
+     */
+    uintptr_t alloc_pages(uint32_t order);
+
+    /**
+     * Free a block allocated by `alloc_pages`.
+     *
+     * @param addr physical address of the block
+     * @param order block order
+     */
+    void free_pages(uintptr_t addr, uint32_t order);
+
+    /**
+     * Allocate physically contiguous frames.
+     *
+     * Frames past the requested count in the underlying block are given
+     * back right away.
+     *
+     * @param count number of frames, at most 2^FRAME_MAX_ORDER
+     * @param align alignment of the first frame in frames, a power of two
+     * @returns physical address of the first frame or 0 if out of memory
+     */
+    uintptr_t alloc_contiguous(size_t count, size_t align);
+
+    /**
+     * Free contiguous frames allocated by `alloc_contiguous`.
+     *
+     * @param addr physical address of the first frame
+     * @param count number of frames
+     */
+    void free_contiguous(uintptr_t addr, size_t count);
+
+    /**
+     * Get number of free frames.
+     *
+     * @returns free frames
+     */
+    size_t get_free();
+
+    /**
+     * Get number of frames managed by the allocator.
+     *
+     * @returns usable frames at boot
+     */
+    size_t get_total();
+
+    /**
+     * Get the end of physical memory managed by the allocator.
+     *
+     * @returns physical address past the highest usable frame
+     */
+    uintptr_t get_limit();
+
+    /**
+     * Get allocator statistics.
+     *
+     * @param stats pointer to statistics to fill
+     */
+    void get_stats(FrameStats *stats);
+
+    /**
+     * Dump free block counts and fragmentation of each order.
+     *
+     * The unusable free space index of an order is the share of free
+     * memory in blocks too small to serve an allocation of that order.
+     *
+     * @param sink sink receiving the formatted output
+     * @param ctx sink context
+     */
+    void dump_stats(format_sink_t sink, void *ctx);
+
+} // namespace PageFrame
+
+} // namespace kernel
+
+#endif /* KERNEL_FRAME_HPP */
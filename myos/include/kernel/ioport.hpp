@@ -26,6 +26,25 @@ void __arch cli();
  */
 void __arch sti();
 
+/**
+ * Save interrupt state and disable interupts.
+ * 
+ * Used to guard short critical sections shared with interrupt handlers.
+ * 
+ * @returns saved interrupt state to pass to `irq_restore`
+ */
+unsigned long __arch irq_save();
+
+/**
+ * Restore interrupt state.
+ * 
+ * Interrupts are enabled again only if they were enabled when the state
+ * was saved.
+ * 
+ * @param flags interrupt state returned by `irq_save`
+ */
+void __arch irq_restore(unsigned long flags);
+
 /**
  * Repeated NOP operation.
  * 
@@ -33,6 +52,15 @@ void __arch sti();
  */
 void __arch rep_nop();
 
+/**
+ * Wait for interrupt.
+ * 
+ * Enables interrupts and halts the CPU until the next interrupt. The two
+ * steps are atomic, so an interrupt arriving in between can not leave
+ * the CPU halted.
+ */
+void __arch halt();
+
 /**
  * Hang CPU.
  * 
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include <kernel/defs.hpp>
+#include <kernel/format.hpp>
 
 #include <arch/isr.hpp>
 
@@ -28,10 +29,48 @@ namespace kernel
         ISRArg arg; // arch specific arguments for ISR
     };
 
+/**
+ * Maximum number of handlers sharing an interrupt vector
+ */
+#define IVT_MAX_SHARED 4
+
+    /**
+     * ISR handler result
+     */
+    enum ISRResult
+    {
+        IRQ_NONE = 0,    // interrupt was not raised by the handler's device
+        IRQ_HANDLED = 1, // interrupt was serviced by the handler
+    };
+
     /** 
      * ISR function pointer typedef
+     * 
+     * Handlers of a shared interrupt line must check their device raised 
+     * the interrupt and return `IRQ_NONE` otherwise.
      */
-    typedef void (*isr_handler_t)(ISRFrame *const frame);
+    typedef ISRResult (*isr_handler_t)(ISRFrame *const frame, void *ctx);
+
+/**
+ * Number of log2 buckets of handler duration histograms. The last bucket
+ * also counts all longer durations.
+ */
+#define IVT_STATS_BUCKETS 24
+
+    /**
+     * Per-vector interrupt handling statistics
+     * 
+     * Durations are measured in processor cycles from entry to the handler
+     * chain up to the end of interrupt acknowledgement, less the time
+     * spent in interrupts nested inside the handlers.
+     */
+    struct ISRStats
+    {
+        uint32_t count;                        // number of interrupts handled
+        uint32_t max_cycles;                   // longest handling duration
+        uint64_t total_cycles;                 // sum of handling durations
+        uint32_t histogram[IVT_STATS_BUCKETS]; // bucket k counts durations in [2^k, 2^(k+1))
+    };
 
     /**
      * Interrupt Vector Table (IVT)
@@ -47,11 +86,24 @@ namespace kernel
          * The routine has the same signature as an interrupt handler.
          * 
          * NOTE: Arch specifc code should implementate interrupt entry stubs
-         *      redirecting execution to this method.
+         *      redirecting execution to this method. The method is exported
+         *      under the unmangled symbol name `isr_entry` for assembly stubs.
+         * 
+         * @param frame pointer to interrupt stack frame
+         */
+        void isr_entry(ISRFrame *const frame) asm("isr_entry");
+
+        /**
+         * Common interrupt handler entry, arch specific part
+         * 
+         * Called before any handler runs. Spurious interrupts raised by the
+         * interrupt controller are acknowledged as required and dropped
+         * without running handlers or `isr_exit`.
          * 
          * @param frame pointer to interrupt stack frame
+         * @returns false if the interrupt must be dropped
          */
-        void isr_entry(ISRFrame *const frame);
+        bool __arch isr_enter(ISRFrame *const frame);
 
         /**
          * Common interrupt handler exit 
@@ -63,13 +115,88 @@ namespace kernel
          */
         void __arch isr_exit(ISRFrame *const frame);
 
+        /**
+         * Check if interrupts were enabled in the interrupted context.
+         * 
+         * @param frame pointer to interrupt stack frame
+         * @returns true if interrupts were enabled
+         */
+        bool __arch irqs_enabled(ISRFrame *const frame);
+
+        /**
+         * Check if handlers of an interrupt may run with interrupts enabled.
+         * 
+         * The interrupt controller must hold back interrupts of the same
+         * and lower priority until `isr_exit`, so only higher priority
+         * interrupts can nest.
+         * 
+         * @param frame pointer to interrupt stack frame
+         * @returns true if interrupts can be enabled for the handlers
+         */
+        bool __arch irq_nestable(ISRFrame *const frame);
+
+        /**
+         * Check if running in interrupt context.
+         * 
+         * @returns true while an interrupt handler runs
+         */
+        bool in_interrupt();
+
         /**
          * Register Interrupt Service Routine (ISR) in Interrupt Vector Table (IVT).
          * 
+         * Handlers registered for the same interrupt number are chained and
+         * run in registration order on each interrupt.
+         * 
          * @param n interrupt number to be assigned to ISR
          * @param isr function pointer to ISR
+         * @param ctx pointer passed to ISR, e.g. the device raising the interrupt
+         * @returns 0 on success and -1 if the handler chain is full
+         */
+        int register_isr(const uint32_t n, isr_handler_t isr, void *ctx = nullptr);
+
+        /**
+         * Unregister Interrupt Service Routine (ISR) from Interrupt Vector Table (IVT).
+         * 
+         * @param n interrupt number assigned to ISR
+         * @param isr function pointer to ISR
+         * @param ctx pointer passed to ISR on registration
+         * @returns 0 on success and -1 if the handler is not registered
+         */
+        int unregister_isr(const uint32_t n, isr_handler_t isr, void *ctx = nullptr);
+
+        /**
+         * Get number of interrupts no registered handler claimed.
+         * 
+         * @param n interrupt number
+         * @returns number of unhandled interrupts
+         */
+        uint32_t get_unhandled(const uint32_t n);
+
+        /**
+         * Get deepest interrupt nesting seen since boot.
+         * 
+         * @returns maximum number of interrupts handled at once
+         */
+        uint32_t get_max_depth();
+
+        /**
+         * Get interrupt handling statistics of a vector.
+         * 
+         * @param n interrupt number
+         * @param stats pointer to statistics to fill
+         * @returns 0 on success and -1 for an invalid interrupt number
+         */
+        int get_stats(const uint32_t n, ISRStats *stats);
+
+        /**
+         * Write statistics of all vectors seen so far in human readable
+         * form.
+         * 
+         * @param sink output sink
+         * @param ctx context passed to sink
          */
-        void register_isr(const uint32_t n, isr_handler_t isr);
+        void dump_stats(format_sink_t sink, void *ctx);
 
     } // namespace IVT
 
@@ -0,0 +1,76 @@
+/**
+ * PS/2 keyboard driver.
+ *
+ * The interrupt handler only drains the 8042 controller output buffer
+ * into a single producer single consumer scancode ring. Scancodes are
+ * translated to keycodes and passed to the console terminal later from
+ * a tasklet, keeping the time spent with interrupts disabled to a few
+ * port reads per key press.
+ */
+
+#ifndef KERNEL_KEYBOARD_HPP
+#define KERNEL_KEYBOARD_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace kernel
+{
+/** Size of scancode ring buffer. Must be a power of 2. */
+#define KEYBOARD_BUFSIZ 256
+
+/**
+ * Keycodes of keys not producing a printable char. Keys producing a char
+ * use the char value as keycode.
+ */
+#define KEY_UP 0x100
+#define KEY_DOWN 0x101
+#define KEY_LEFT 0x102
+#define KEY_RIGHT 0x103
+#define KEY_HOME 0x104
+#define KEY_END 0x105
+#define KEY_INSERT 0x106
+#define KEY_DELETE 0x107
+#define KEY_PAGE_UP 0x108
+#define KEY_PAGE_DOWN 0x109
+
+namespace Keyboard
+{
+    /**
+     * Initialize keyboard controller and register interrupt handler.
+     *
+     * @returns 0 on success and -1 if no working controller is found
+     */
+    int init();
+
+    /**
+     * Drain scancodes from the controller into the scancode ring.
+     *
+     * NOTE: Called from interrupt context.
+     *
+     * @returns true if the controller had data pending
+     */
+    bool handle_interrupt();
+
+    /**
+     * Translate queued scancodes and pass the resulting input to the
+     * console terminal.
+     *
+     * NOTE: Called from the keyboard tasklet.
+     *
+     * @returns number of scancodes processed
+     */
+    size_t process();
+
+    /**
+     * Get number of scancodes dropped due to a full scancode ring.
+     *
+     * @returns number of dropped scancodes
+     */
+    uint32_t get_overruns();
+
+} // namespace Keyboard
+
+} // namespace kernel
+
+#endif /* KERNEL_KEYBOARD_HPP */
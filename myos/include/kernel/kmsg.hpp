@@ -0,0 +1,72 @@
+/**
+ * Kernel message ring buffer.
+ * 
+ * Kernel log messages are formatted into timestamped records of a ring 
+ * buffer and returned right away. Producers reserve space in the ring 
+ * with atomic operations only, so messages can be logged from any context 
+ * including interrupt handlers. The records are later drained to the
+ * console devices from a low priority context.
+ */
+
+#ifndef KERNEL_KMSG_HPP
+#define KERNEL_KMSG_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+namespace kernel
+{
+/** Size of the message ring buffer in bytes. Must be a power of 2. */
+#define KMSG_BUFSIZ (1 << 14)
+
+/** Maximum length of the text of a single message */
+#define KMSG_TEXT_MAX 1000
+
+namespace KMsg
+{
+    /**
+     * Log a formatted message with variable arguments.
+     * 
+     * The message is dropped if the ring buffer is full.
+     * 
+     * @param level log level of message
+     * @param tag subsystem tag or nullptr. Must point to a string literal.
+     * @param fmt text string to log
+     * @param args additional arguments
+     * @returns number of chars logged
+     */
+    int vlog(int level, const char *tag, const char *fmt, va_list args);
+
+    /**
+     * Log a formatted message.
+     * 
+     * @param level log level of message
+     * @param tag subsystem tag or nullptr. Must point to a string literal.
+     * @param fmt text string to log
+     * @returns number of chars logged
+     */
+    int log(int level, const char *tag, const char *fmt, ...);
+
+    /**
+     * Write all committed messages to the console devices.
+     * 
+     * Only one context drains the ring at a time. A call made while 
+     * another drain is in progress returns right away.
+     * 
+     * @returns number of messages written
+     */
+    size_t drain();
+
+    /**
+     * Get number of messages dropped due to a full ring buffer.
+     * 
+     * @returns number of dropped messages
+     */
+    uint32_t dropped();
+
+} // namespace KMsg
+
+} // namespace kernel
+
+#endif /* KERNEL_KMSG_HPP */
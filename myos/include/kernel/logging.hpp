@@ -0,0 +1,126 @@
+/**
+ * Leveled kernel logging.
+ * 
+ * Messages are logged with a severity level and a subsystem tag using the 
+ * `LOG_DEBUG`, `LOG_INFO`, `LOG_WARN` and `LOG_ERROR` macros. Levels below 
+ * the build time threshold `CONFIG_LOG_LEVEL` compile to nothing, so their
+ * format strings and arguments are never evaluated. Levels at or above it
+ * are further filtered at run time by `kernel::Log::level`, which can be set 
+ * with the `loglevel=` kernel command line option.
+ * 
+ * Example:
+ *  LOG_INFO("pit", "timer running at %d Hz\n", CLOCKS_PER_SEC);
+ */
+
+#ifndef KERNEL_LOGGING_HPP
+#define KERNEL_LOGGING_HPP
+
+#include <stdarg.h>
+
+/**
+ * Log levels
+ */
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+/**
+ * Build time log level threshold. Set through the `KERNEL_LOG_LEVEL` cmake 
+ * cache variable.
+ */
+#ifndef CONFIG_LOG_LEVEL
+#define CONFIG_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+namespace kernel
+{
+namespace Log
+{
+    /**
+     * Run time log level threshold. Messages below this level are dropped 
+     * before formatting.
+     */
+    extern int level;
+
+    /**
+     * Log a formatted message with variable arguments.
+     * 
+     * @param level log level of message
+     * @param tag subsystem tag. Must point to a string literal.
+     * @param fmt text string to log
+     * @param args additional arguments
+     */
+    void vlog(int level, const char *tag, const char *fmt, va_list args);
+
+    /**
+     * Log a formatted message.
+     * 
+     * @param level log level of message
+     * @param tag subsystem tag. Must point to a string literal.
+     * @param fmt text string to log
+     */
+    void log(int level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+    /**
+     * Set run time log level threshold from kernel command line.
+     * 
+     * The option `loglevel=` accepts a level name (debug, info, warn, 
+     * error, none) or its number.
+     * 
+     * @param cmdline kernel command line
+     */
+    void parse_cmdline(const char *cmdline);
+
+} // namespace Log
+
+} // namespace kernel
+
+/**
+ * Log a message if its level passes the run time threshold.
+ */
+#define LOG(lvl, tag, fmt, ...)                               \
+    do                                                        \
+    {                                                         \
+        if ((lvl) >= kernel::Log::level)                      \
+            kernel::Log::log((lvl), (tag), fmt, ##__VA_ARGS__); \
+    } while (0)
+
+#if CONFIG_LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(tag, fmt, ...) LOG(LOG_LEVEL_DEBUG, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, fmt, ...) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
+
+#if CONFIG_LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(tag, fmt, ...) LOG(LOG_LEVEL_INFO, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(tag, fmt, ...) \
+    do                          \
+    {                           \
+    } while (0)
+#endif
+
+#if CONFIG_LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(tag, fmt, ...) LOG(LOG_LEVEL_WARN, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(tag, fmt, ...) \
+    do                          \
+    {                           \
+    } while (0)
+#endif
+
+#if CONFIG_LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(tag, fmt, ...) LOG(LOG_LEVEL_ERROR, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(tag, fmt, ...) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
+
+#endif /* KERNEL_LOGGING_HPP */
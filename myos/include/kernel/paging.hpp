@@ -0,0 +1,105 @@
+/**
+ * Kernel virtual memory mapping interface. The implementation of these
+ * routines are architecture dependent.
+ *
+ * Mappings are changed in the current address space one page at a time.
+ * Addresses and sizes are rounded out to whole pages. Protection flags
+ * are the `PAGE_*` flags of the architecture.
+ *
+ * The kernel direct map may use large pages, which can not be changed
+ * one page at a time. Mappings in it are left alone.
+ */
+
+#ifndef KERNEL_PAGING_HPP
+#define KERNEL_PAGING_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <arch/page.hpp>
+#include <kernel/defs.hpp>
+
+namespace kernel
+{
+namespace Paging
+{
+    /**
+     * Map all physical memory managed by the frame allocator into the
+     * kernel direct map and drop the boot identity mapping. Called once
+     * the frame allocator is initialized.
+     *
+     * Where the processor supports them, the direct map including the
+     * kernel image uses large pages and kernel mappings are global.
+     *
+     * @returns 0 on success and -1 if out of memory for page tables
+     */
+    int __arch init();
+
+    /**
+     * Map a range of physical memory.
+     *
+     * Page tables are allocated as needed. Existing mappings in the range
+     * are replaced.
+     *
+     * @param virt virtual address
+     * @param phys physical address
+     * @param size size in bytes
+     * @param flags page protection flags
+     * @returns 0 on success and -1 if out of memory for page tables or the
+     *          range overlaps a large page
+     */
+    int __arch map(uintptr_t virt, uintptr_t phys, size_t size, uint32_t flags);
+
+    /**
+     * Unmap a range of virtual memory. Pages not mapped or in a large page
+     * are skipped.
+     *
+     * @param virt virtual address
+     * @param size size in bytes
+     */
+    void __arch unmap(uintptr_t virt, size_t size);
+
+    /**
+     * Change the protection of a mapped range of virtual memory.
+     *
+     * @param virt virtual address
+     * @param size size in bytes
+     * @param flags page protection flags
+     * @returns 0 on success and -1 if a page in the range is not mapped or
+     *          in a large page
+     */
+    int __arch protect(uintptr_t virt, size_t size, uint32_t flags);
+
+    /**
+     * Translate a virtual address.
+     *
+     * @param virt virtual address
+     * @param phys pointer to store the physical address
+     * @returns 0 on success and -1 if the address is not mapped
+     */
+    int __arch translate(uintptr_t virt, uintptr_t *phys);
+
+    /**
+     * Map device memory into the kernel address space. Caching is
+     * disabled for the mapping. Memory already in the direct map is
+     * returned as is.
+     *
+     * @param phys physical address
+     * @param size size in bytes
+     * @returns virtual address of `phys` or nullptr if out of address space
+     */
+    void *__arch ioremap(uintptr_t phys, size_t size);
+
+    /**
+     * Unmap device memory mapped by `ioremap`.
+     *
+     * @param addr virtual address returned by `ioremap`
+     * @param size size in bytes passed to `ioremap`
+     */
+    void __arch iounmap(void *addr, size_t size);
+
+} // namespace Paging
+
+} // namespace kernel
+
+#endif /* KERNEL_PAGING_HPP */
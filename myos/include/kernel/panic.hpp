@@ -13,7 +13,7 @@ namespace kernel
  * 
  * This function never returns.
  */
-void panic(const char *__restrict fmt, ...);
+void panic(const char *__restrict fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
 
 } // namespace kernel
 
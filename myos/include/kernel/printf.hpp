@@ -12,6 +12,9 @@ namespace kernel
  * 
  * This method should be used to print from inside
  * the kernel as it uses high level TTY interfaces.
+ * The text is queued in the kernel message ring and
+ * written to the TTY when the ring is drained, so it
+ * is safe to call from interrupt handlers.
  * 
  * @param fmt text string to print 
  * @param args additional arguments
@@ -26,7 +29,7 @@ void vprintf(const char *fmt, va_list args);
  *
  * @param fmt text string to print
  */
-void printf(const char *fmt, ...);
+void printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
 
 } // namespace kernel
 
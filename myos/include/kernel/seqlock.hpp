@@ -0,0 +1,129 @@
+/**
+ * Sequence counters and locks.
+ *
+ * Readers never block writers and never take a lock. A writer makes the
+ * sequence number odd while it updates the protected data and even again
+ * after. A reader samples the sequence number before and after reading
+ * and retries when a write was in progress or completed in between.
+ *
+ * Suited for small, frequently read and rarely written data such as
+ * clocks. Readers interrupted by a writer simply retry, so the data can
+ * be written from interrupt handlers.
+ */
+
+#ifndef KERNEL_SEQLOCK_HPP
+#define KERNEL_SEQLOCK_HPP
+
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+
+namespace kernel
+{
+/**
+ * Sequence counter
+ *
+ * Writers must already be serialized, for example by running from a
+ * single interrupt handler.
+ */
+struct SeqCount
+{
+    uint32_t sequence; /**< Odd while a write is in progress */
+
+    /**
+     * Begin a read section.
+     *
+     * @returns sequence number to pass to `read_retry`
+     */
+    uint32_t read_begin() const
+    {
+        uint32_t seq;
+        while ((seq = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE)) & 1)
+            kernel::rep_nop();
+        return seq;
+    }
+
+    /**
+     * End a read section.
+     *
+     * @param seq sequence number returned by `read_begin`
+     * @returns true if the data read is inconsistent and must be read again
+     */
+    bool read_retry(uint32_t seq) const
+    {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return __atomic_load_n(&sequence, __ATOMIC_RELAXED) != seq;
+    }
+
+    /**
+     * Begin a write section.
+     */
+    void write_begin()
+    {
+        __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    /**
+     * End a write section.
+     */
+    void write_end()
+    {
+        __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELEASE);
+    }
+
+    SeqCount() : sequence(0) {}
+};
+
+/**
+ * Sequence lock
+ *
+ * A sequence counter whose writers are serialized by disabling
+ * interrupts, so any context can write.
+ */
+struct SeqLock
+{
+    SeqCount seqcount; /**< Sequence counter */
+
+    /**
+     * Begin a read section.
+     *
+     * @returns sequence number to pass to `read_retry`
+     */
+    uint32_t read_begin() const { return seqcount.read_begin(); }
+
+    /**
+     * End a read section.
+     *
+     * @param seq sequence number returned by `read_begin`
+     * @returns true if the data read is inconsistent and must be read again
+     */
+    bool read_retry(uint32_t seq) const { return seqcount.read_retry(seq); }
+
+    /**
+     * Begin a write section.
+     *
+     * @returns saved interrupt state to pass to `write_unlock`
+     */
+    unsigned long write_lock()
+    {
+        unsigned long flags = kernel::irq_save();
+        seqcount.write_begin();
+        return flags;
+    }
+
+    /**
+     * End a write section.
+     *
+     * @param flags interrupt state returned by `write_lock`
+     */
+    void write_unlock(unsigned long flags)
+    {
+        seqcount.write_end();
+        kernel::irq_restore(flags);
+    }
+};
+
+} // namespace kernel
+
+#endif /* KERNEL_SEQLOCK_HPP */
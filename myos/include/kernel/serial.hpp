@@ -0,0 +1,109 @@
+#ifndef KERNEL_SERIAL_HPP
+#define KERNEL_SERIAL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace kernel
+{
+/** Base I/O port of standard serial ports */
+#define SERIAL_COM1 0x3F8
+#define SERIAL_COM2 0x2F8
+
+/** Default serial line baud rate */
+#define SERIAL_BAUD 115200
+
+/** Size of software transmit ring buffer. Must be a power of 2. */
+#define SERIAL_TX_BUFSIZ 4096
+
+/**
+ * 16550 UART serial port driver.
+ * 
+ * Output is queued in a software ring buffer and moved to the 16 byte 
+ * hardware transmit FIFO from the transmitter holding register empty 
+ * (THRE) interrupt, so writers never wait on the serial line.
+ */
+class Serial
+{
+private:
+    uint16_t port;          /**< Base I/O port */
+    bool present;           /**< UART passed loopback test */
+    uint8_t ier;            /**< Interrupt enable register value */
+    uint32_t tx_head;       /**< Transmit ring write position */
+    uint32_t tx_tail;       /**< Transmit ring read position */
+    uint32_t overruns;      /**< Chars dropped due to a full transmit ring */
+    char tx_buffer[SERIAL_TX_BUFSIZ];
+
+    /**
+     * Move queued chars to the hardware transmit FIFO and enable the THRE 
+     * interrupt while chars remain queued. 
+     * 
+     * NOTE: Must be called with interrupts disabled and an empty transmit
+     *      FIFO.
+     */
+    void fill_fifo();
+
+public:
+    /**
+     * Initialize serial port.
+     * 
+     * @param port base I/O port of the UART
+     * @param baud line baud rate
+     * @returns 0 on success and -1 if no working UART is found
+     */
+    int init(uint16_t port, uint32_t baud);
+
+    /**
+     * Queue chars for transmission.
+     * 
+     * @param buffer pointer to the first char
+     * @param n number of chars to write
+     * @returns number of chars queued
+     */
+    int write(const char *buffer, size_t n);
+
+    /**
+     * Transmit all queued chars by polling the line status register.
+     * 
+     * Used when interrupts are disabled, e.g. on panic.
+     */
+    void sync();
+
+    /**
+     * Service pending UART interrupts.
+     * 
+     * @returns true if the UART had an interrupt pending
+     */
+    bool handle_interrupt();
+
+    /**
+     * Check if a working UART was found by `init`.
+     * 
+     * @returns true if serial port is usable
+     */
+    bool is_present() { return present; }
+
+    /**
+     * Get number of chars dropped due to a full transmit ring.
+     * 
+     * @returns number of dropped chars
+     */
+    uint32_t get_overruns() { return overruns; }
+
+    /**
+     * Formatter sink writing to a serial port.
+     * 
+     * @param ctx pointer to serial port
+     * @param s pointer to the first char
+     * @param n number of chars to write
+     */
+    static void sink(void *ctx, const char *s, size_t n);
+};
+
+/** Serial ports COM1 and COM2 */
+extern Serial serial1;
+extern Serial serial2;
+
+} // namespace kernel
+
+#endif /* KERNEL_SERIAL_HPP */
@@ -0,0 +1,121 @@
+/**
+ * Object cache allocator.
+ *
+ * Each cache hands out objects of one size carved from slabs, blocks of
+ * page frames taken from the frame allocator. Successive slabs start
+ * their objects at a different cache line offset (slab coloring), so
+ * objects at the same index of different slabs do not compete for the
+ * same processor cache sets.
+ *
+ * Freed objects are kept in magazines, small stacks of object pointers,
+ * in front of the slab layer. The common alloc and free pair only pops
+ * and pushes the magazines of the current CPU. Full and empty magazines
+ * are exchanged with a per cache depot, and only then the slab lists are
+ * touched.
+ */
+
+#ifndef KERNEL_SLAB_HPP
+#define KERNEL_SLAB_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kernel/format.hpp>
+
+/** Maximum length of a cache name including the terminating null */
+#define KMEM_CACHE_NAME_MAX 16
+
+namespace kernel
+{
+/**
+ * Object cache, opaque to users
+ */
+struct KmemCache;
+
+/**
+ * Object cache statistics
+ */
+struct KmemCacheStats
+{
+    size_t object_size;      // object size including alignment padding
+    size_t slab_size;        // slab size in bytes
+    size_t objects_per_slab; // objects in a slab
+    size_t nr_slabs;         // slabs held by the cache
+    size_t nr_active;        // objects handed out to users
+    size_t nr_cached;        // free objects held in magazines
+    uint32_t allocs;         // objects allocated
+    uint32_t frees;          // objects freed
+    uint32_t magazine_hits;  // allocations served from a magazine
+    uint32_t grows;          // slabs allocated
+    uint32_t reaps;          // slabs released
+    uint32_t failures;       // allocations failed for lack of memory
+};
+
+/**
+ * Initialize the object cache allocator. Called once the kernel direct
+ * map is set up.
+ */
+void kmem_cache_init();
+
+/**
+ * Create an object cache.
+ *
+ * @param name cache name, truncated to `KMEM_CACHE_NAME_MAX` - 1 chars
+ * @param size object size in bytes, at most an eighth of the largest slab
+ * @param align object alignment, a power of two or 0 for word alignment
+ * @returns pointer to cache or nullptr on failure
+ */
+KmemCache *kmem_cache_create(const char *name, size_t size, size_t align);
+
+/**
+ * Destroy an object cache. All objects must have been freed.
+ *
+ * @param cache pointer to cache
+ * @returns 0 on success and -1 if objects are still in use
+ */
+int kmem_cache_destroy(KmemCache *cache);
+
+/**
+ * Allocate an object. Can be called from any context.
+ *
+ * @param cache pointer to cache
+ * @returns pointer to uninitialized object or nullptr if out of memory
+ */
+void *kmem_cache_alloc(KmemCache *cache);
+
+/**
+ * Free an object allocated from a cache. Can be called from any context.
+ *
+ * @param cache pointer to cache the object was allocated from
+ * @param object pointer to object
+ */
+void kmem_cache_free(KmemCache *cache, void *object);
+
+/**
+ * Return the objects held in magazines to their slabs and release the
+ * empty slabs to the frame allocator.
+ *
+ * @param cache pointer to cache
+ * @returns number of frames released
+ */
+size_t kmem_cache_shrink(KmemCache *cache);
+
+/**
+ * Get cache statistics.
+ *
+ * @param cache pointer to cache
+ * @param stats pointer to statistics to fill
+ */
+void kmem_cache_get_stats(KmemCache *cache, KmemCacheStats *stats);
+
+/**
+ * Dump usage statistics of all caches.
+ *
+ * @param sink sink receiving the formatted output
+ * @param ctx sink context
+ */
+void kmem_cache_dump_stats(format_sink_t sink, void *ctx);
+
+} // namespace kernel
+
+#endif /* KERNEL_SLAB_HPP */
@@ -0,0 +1,107 @@
+/**
+ * Deferred interrupt work.
+ *
+ * Interrupt handlers (the top half) only acknowledge their device and
+ * raise a softirq or schedule a tasklet for the rest of the work (the
+ * bottom half). Pending softirqs run with interrupts enabled on exit
+ * from the outermost interrupt, so the time spent with interrupts
+ * disabled stays short and bounded.
+ */
+
+#ifndef KERNEL_SOFTIRQ_HPP
+#define KERNEL_SOFTIRQ_HPP
+
+#include <stdint.h>
+
+namespace kernel
+{
+/** Maximum number of softirqs */
+#define NR_SOFTIRQS 8
+
+/**
+ * Softirq numbers. Lower numbers run first.
+ */
+#define SOFTIRQ_TIMER 0
+#define SOFTIRQ_TASKLET 1
+
+/**
+ * Number of times pending softirqs are rerun on a single interrupt exit
+ * before the rest is left for the idle loop.
+ */
+#define SOFTIRQ_MAX_RESTART 10
+
+/**
+ * Softirq handler function pointer typedef
+ */
+typedef void (*softirq_handler_t)();
+
+namespace SoftIRQ
+{
+    /**
+     * Register softirq handler.
+     *
+     * @param n softirq number
+     * @param handler function pointer to handler
+     */
+    void open(uint32_t n, softirq_handler_t handler);
+
+    /**
+     * Mark a softirq pending. Can be called from any context.
+     *
+     * @param n softirq number
+     */
+    void raise(uint32_t n);
+
+    /**
+     * Run pending softirqs with interrupts enabled.
+     *
+     * A call made while softirqs are already running on the interrupted
+     * context returns right away.
+     */
+    void run();
+
+    /**
+     * Check for pending softirqs.
+     *
+     * @returns true if any softirq is pending
+     */
+    bool pending();
+
+} // namespace SoftIRQ
+
+/**
+ * Tasklet function pointer typedef
+ */
+typedef void (*tasklet_func_t)(unsigned long data);
+
+/**
+ * Tasklet
+ *
+ * A deferred function run once from the tasklet softirq after being
+ * scheduled, no matter how many times it was scheduled in between.
+ */
+struct Tasklet
+{
+    Tasklet *next;       /**< Next scheduled tasklet */
+    tasklet_func_t func; /**< Function to run */
+    unsigned long data;  /**< Argument passed to function */
+    bool scheduled;      /**< Tasklet is waiting to run */
+
+    /**
+     * Schedule tasklet to run. Can be called from any context.
+     */
+    void schedule();
+
+    /**
+     * Constructor to initialize tasklet
+     *
+     * @param func function to run
+     * @param data argument passed to function
+     */
+    Tasklet(tasklet_func_t func, unsigned long data)
+        : next(nullptr), func(func), data(data), scheduled(false) {}
+};
+
+} // namespace kernel
+
+#endif /* KERNEL_SOFTIRQ_HPP */
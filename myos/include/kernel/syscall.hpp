@@ -0,0 +1,30 @@
+/**
+ * System call dispatch.
+ *
+ * System call numbers are shared with the C library through
+ * `<sys/syscall.h>`. The arch specific trap handler passes the call
+ * number and arguments to `syscall` and returns its result to the
+ * caller.
+ */
+
+#ifndef KERNEL_SYSCALL_HPP
+#define KERNEL_SYSCALL_HPP
+
+#include <stdint.h>
+
+namespace kernel
+{
+/**
+ * Run a system call.
+ *
+ * @param n system call number
+ * @param arg1 first argument
+ * @param arg2 second argument
+ * @param arg3 third argument
+ * @returns system call result, or a negated errno on failure
+ */
+long syscall(uint32_t n, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+} // namespace kernel
+
+#endif /* KERNEL_SYSCALL_HPP */
@@ -0,0 +1,126 @@
+/**
+ * Kernel time keeping interface. The implementation of these routines 
+ * are architecture dependent.
+ */
+
+#ifndef KERNEL_TIME_HPP
+#define KERNEL_TIME_HPP
+
+#include <stdint.h>
+
+#include <kernel/defs.hpp>
+
+/** Nanoseconds in a second */
+#define NSEC_PER_SEC 1000000000ULL
+
+namespace kernel
+{
+/**
+ * Get system clock ticks since boot.
+ * 
+ * The system clock ticks `CLOCKS_PER_SEC` times a second.
+ * 
+ * @returns system clock ticks
+ */
+uint32_t __arch get_ticks();
+
+/**
+ * Get 64-bit system clock ticks since boot.
+ * 
+ * Read consistently from any context and never wraps around.
+ * 
+ * @returns system clock ticks
+ */
+uint64_t __arch get_ticks64();
+
+/**
+ * Get processor cycle counter.
+ * 
+ * Cheap to read and used to time short code paths. The counter rate is
+ * processor specific.
+ * 
+ * @returns processor cycles
+ */
+uint64_t __arch get_cycles();
+
+/**
+ * Get monotonic nanoseconds since boot.
+ * 
+ * Backed by a fine grained clock source when the processor provides one
+ * and by the system clock ticks otherwise. Cheap enough to timestamp
+ * hot paths.
+ * 
+ * @returns nanoseconds since boot
+ */
+uint64_t __arch ktime_get_ns();
+
+/**
+ * Read the battery backed persistent clock.
+ * 
+ * @returns seconds since the Unix epoch
+ */
+uint64_t __arch read_persistent_clock();
+
+/**
+ * Initialize the wall clock from the persistent clock.
+ * 
+ * Must be called after the monotonic clock source is set up.
+ */
+void clock_init();
+
+/**
+ * Set the wall clock.
+ * 
+ * @param ns nanoseconds since the Unix epoch
+ */
+void clock_settime(uint64_t ns);
+
+/**
+ * Get wall clock time.
+ * 
+ * Lock free, readers retry if the wall clock is set meanwhile.
+ * 
+ * @returns nanoseconds since the Unix epoch
+ */
+uint64_t ktime_get_real_ns();
+
+/**
+ * Stop the periodic system clock tick.
+ * 
+ * A one-shot timer interrupt is programmed instead. The delay may be
+ * clamped to the longest one supported by the timer hardware. Must be
+ * called with interrupts disabled.
+ * 
+ * @param delta delay in ticks until the next timer deadline
+ * @returns delay programmed in ticks, 0 if the tick was not stopped
+ */
+uint32_t __arch tick_stop(uint32_t delta);
+
+/**
+ * Restart the periodic system clock tick stopped by `tick_stop`.
+ * 
+ * Ticks elapsed while stopped are accounted for. Must be called with
+ * interrupts disabled.
+ */
+void __arch tick_restart();
+
+namespace Tick
+{
+    /**
+     * Idle the CPU until the next interrupt.
+     * 
+     * The periodic tick is stopped while idle when the next timer
+     * deadline is more than a tick away, so an idle system is not woken
+     * up on every tick.
+     * 
+     * Can be called with interrupts disabled, so callers can check their
+     * wakeup condition without racing an interrupt. Returns with
+     * interrupts enabled.
+     */
+    void idle();
+
+} // namespace Tick
+
+} // namespace kernel
+
+#endif /* KERNEL_TIME_HPP */
@@ -0,0 +1,121 @@
+/**
+ * Kernel timers.
+ *
+ * Timers run a function once the system clock reaches their expiry
+ * time. Pending timers are kept in a hierarchical timing wheel: timers
+ * due within the next 256 ticks sit in per-tick slots of the first
+ * level, later ones in coarser slots of four outer levels and are
+ * cascaded down as their expiry time comes closer. Adding and removing a
+ * timer takes constant time.
+ *
+ * Expired timers run in batches from the timer softirq.
+ */
+
+#ifndef KERNEL_TIMER_HPP
+#define KERNEL_TIMER_HPP
+
+#include <stdint.h>
+
+namespace kernel
+{
+/**
+ * Compare system clock ticks handling wrap around.
+ *
+ * @returns true if tick count `a` is after `b`
+ */
+#define time_after(a, b) ((int32_t)((b) - (a)) < 0)
+#define time_after_eq(a, b) ((int32_t)((a) - (b)) >= 0)
+#define time_before(a, b) time_after(b, a)
+#define time_before_eq(a, b) time_after_eq(b, a)
+
+/**
+ * Timer function pointer typedef
+ */
+typedef void (*timer_func_t)(unsigned long data);
+
+/**
+ * Timer
+ */
+struct Timer
+{
+    Timer *next;        /**< Next timer in wheel slot */
+    Timer **pprev;      /**< Link pointing to this timer, null if not pending */
+    uint32_t expires;   /**< System clock ticks at which the timer expires */
+    timer_func_t func;  /**< Function to run */
+    unsigned long data; /**< Argument passed to function */
+
+    /**
+     * Check if timer is pending.
+     *
+     * @returns true if timer is waiting to expire
+     */
+    bool pending() const { return pprev != nullptr; }
+
+    /**
+     * Constructor to initialize timer
+     *
+     * @param func function to run on expiry
+     * @param data argument passed to function
+     */
+    Timer(timer_func_t func, unsigned long data)
+        : next(nullptr), pprev(nullptr), expires(0), func(func), data(data) {}
+};
+
+/**
+ * Initialize timers.
+ *
+ * Opens the timer softirq. Timers expire from the first tick after.
+ */
+void timer_init();
+
+/**
+ * Start a timer expiring at `timer->expires`. The timer must not be
+ * pending. Can be called from any context.
+ *
+ * @param timer pointer to timer
+ */
+void add_timer(Timer *timer);
+
+/**
+ * Modify the expiry time of a timer. Pending timers are moved and idle
+ * timers are started. Can be called from any context, including the
+ * timer function itself.
+ *
+ * @param timer pointer to timer
+ * @param expires system clock ticks at which the timer expires
+ * @returns 1 if the timer was pending and 0 otherwise
+ */
+int mod_timer(Timer *timer, uint32_t expires);
+
+/**
+ * Stop a pending timer. Can be called from any context.
+ *
+ * @param timer pointer to timer
+ * @returns 1 if the timer was pending and 0 otherwise
+ */
+int del_timer(Timer *timer);
+
+/**
+ * Get the next timer deadline.
+ *
+ * Exact for timers due within the next 256 ticks. Otherwise the next
+ * time timers cascade down the wheel is returned, which is never later
+ * than the actual deadline.
+ *
+ * @returns system clock ticks of the next timer deadline
+ */
+uint32_t next_timer_event();
+
+/**
+ * Sleep for at least the given number of milliseconds.
+ *
+ * The CPU idles until the sleep timer expires. Must be called with
+ * interrupts enabled and outside of interrupt context.
+ *
+ * @param ms milliseconds to sleep
+ */
+void msleep(uint32_t ms);
+
+} // namespace kernel
+
+#endif /* KERNEL_TIMER_HPP */
@@ -9,32 +9,113 @@ namespace kernel
 {
 #define MAX_CANON 256
 
+/** Number of terminals */
+#define NR_TTY 4
+
+/** Terminals attached to the system console devices */
+#define TTY_CONSOLE 0
+#define TTY_SERIAL 1
+
+/** Size of terminal input and output queues. Must be a power of 2. */
+#define TTY_BUFSIZ 1024
+
+/**
+ * TTY device write function pointer typedef
+ *
+ * @param device pointer to device
+ * @param buffer pointer to the first char
+ * @param n number of chars to write
+ * @returns number of chars accepted by device
+ */
+typedef int (*tty_write_t)(void *device, const char *buffer, size_t n);
+
 /**
- * TTY class used by the kernel to interface with a console device such 
- * as a VGA screen.
+ * TTY class used by the kernel to interface with a console device such
+ * as a VGA screen or a serial port.
+ *
+ * Each terminal queues its output and writes it to its device in batches,
+ * so a slow device only holds back its own terminal. Input received from
+ * the device passes through a canonical or raw line discipline driven by
+ * the termios attributes before it is queued for reading.
  */
 class TTY
 {
 private:
-    /**
-     * TODO: Add device attributes and support multiple consoles. 
-     *       For now we interface with a single display console
-     */
-
     struct termios attr;    /* termios attributes */
+    tty_write_t dev_write;  /*<< Device write routine */
+    void *device;           /*<< Device attached to terminal */
     char buffer[MAX_CANON]; /*<< Canonical input line */
-    size_t read_pos;        /*<< Input line position to read */
     size_t write_pos;       /*<< Input line position to write */
 
+    char input[TTY_BUFSIZ];  /*<< Input queue ready to be read */
+    uint32_t input_head;     /*<< Input queue write position */
+    uint32_t input_tail;     /*<< Input queue read position */
+    char output[TTY_BUFSIZ]; /*<< Output queue waiting for device */
+    uint32_t output_head;    /*<< Output queue write position */
+    uint32_t output_tail;    /*<< Output queue read position */
+
+    /**
+     * Queue chars for output applying output processing.
+     *
+     * @param s pointer to the first char
+     * @param n number of chars to queue
+     * @returns number of chars queued
+     */
+    size_t queue_output(const char *s, size_t n);
+
+    /**
+     * Queue chars ready to be read.
+     *
+     * @param s pointer to the first char
+     * @param n number of chars to queue
+     */
+    void queue_input(const char *s, size_t n);
+
+    /**
+     * Echo an input char if enabled.
+     *
+     * @param c char to echo
+     */
+    void echo(char c);
+
+    /**
+     * Write queued output to the device.
+     *
+     * NOTE: Must be called with interrupts disabled.
+     */
+    void flush_output();
+
 public:
     /**
     * Initialize terminal
     */
     void init(void);
 
+    /**
+     * Attach a device to terminal.
+     *
+     * @param dev_write device write routine
+     * @param device pointer to device
+     */
+    void attach(tty_write_t dev_write, void *device);
+
+    /**
+     * Get terminal attributes.
+     *
+     * @param attr pointer to termios struct to fill
+     */
+    void get_attr(struct termios *attr);
+
+    /**
+     * Set terminal attributes.
+     *
+     * @param attr pointer to termios attributes to set
+     */
+    void set_attr(const struct termios *attr);
+
     /**
     * Write a single char on terminal
-    * 
+    *
     * @param c charecter to write on terminal
     * @returns number of characters written
     */
@@ -42,13 +123,37 @@ public:
 
     /**
     * Write string of chars on terminal.
-    * 
+    *
     * @param buffer pointer to memory address of the first char
     * @param n number of char to write
     * @returns number of characters written
     */
     int write(const char *buffer, size_t n);
 
+    /**
+     * Write queued output to the device.
+     */
+    void flush();
+
+    /**
+     * Pass input chars received from the device through the line
+     * discipline.
+     *
+     * @param buffer pointer to the first char
+     * @param n number of chars received
+     */
+    void receive(const char *buffer, size_t n);
+
+    /**
+     * Read input chars without blocking. In canonical mode only complete
+     * lines are available to read.
+     *
+     * @param buffer pointer to memory to read into
+     * @param n maximum number of chars to read
+     * @returns number of chars read
+     */
+    int read(char *buffer, size_t n);
+
     /**
      * Constructor to initialize tty
      */
@@ -56,10 +161,20 @@ public:
 };
 
 /**
- * TTY object to interface with console
- * TODO: Add class to interface with multiple tty
+ * Terminals. The first two are attached to the VGA console and serial
+ * port by `tty_init`.
+ */
+extern TTY ttys[NR_TTY];
+
+/**
+ * Attach system console devices to terminals.
+ */
+void tty_init();
+
+/**
+ * Write queued output of all terminals to their devices.
  */
-extern TTY tty;
+void tty_flush();
 
 } // namespace kernel
 
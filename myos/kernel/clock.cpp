@@ -0,0 +1,36 @@
+#include <stdint.h>
+
+#include <kernel/seqlock.hpp>
+#include <kernel/time.hpp>
+
+/**
+ * Wall clock time minus monotonic clock time in nanoseconds
+ */
+static uint64_t wall_offset = 0;
+static kernel::SeqLock wall_lock;
+
+void kernel::clock_init()
+{
+    kernel::clock_settime(kernel::read_persistent_clock() * NSEC_PER_SEC);
+}
+
+void kernel::clock_settime(uint64_t ns)
+{
+    unsigned long flags = wall_lock.write_lock();
+    wall_offset = ns - kernel::ktime_get_ns();
+    wall_lock.write_unlock(flags);
+}
+
+uint64_t kernel::ktime_get_real_ns()
+{
+    uint64_t offset;
+    uint32_t seq;
+
+    do
+    {
+        seq = wall_lock.read_begin();
+        offset = wall_offset;
+    } while (wall_lock.read_retry(seq));
+
+    return kernel::ktime_get_ns() + offset;
+}
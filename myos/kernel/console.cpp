@@ -2,9 +2,9 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <string.h>
-#include <stdio.h>
 
 #include <kernel/ioport.hpp>
+#include <kernel/format.hpp>
 #include <kernel/console.hpp>
 
 kernel::Console kernel::console;
@@ -19,67 +19,194 @@ void kernel::Console::set_bg_color(enum VGAColor bg_color)
     color = (color & 0x0f) | uint8_t(bg_color) << 4;
 }
 
-void kernel::Console::clrscr()
+void kernel::Console::mark_dirty(size_t row, size_t start, size_t end)
+{
+    if (dirty_start[row] >= dirty_end[row])
+    {
+        dirty_start[row] = start;
+        dirty_end[row] = end;
+        return;
+    }
+    if (start < dirty_start[row])
+        dirty_start[row] = start;
+    if (end > dirty_end[row])
+        dirty_end[row] = end;
+}
+
+void kernel::Console::scroll()
+{
+    const uint16_t blank = ' ' | (uint16_t)color << 8;
+
+    memmove(shadow, shadow + VGA_WIDTH, (VGA_HEIGHT - 1) * VGA_WIDTH * sizeof(uint16_t));
+    for (size_t x = 0; x < VGA_WIDTH; x++)
+        shadow[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = blank;
+
+    /**
+     * Scroll in hardware by moving the screen start address one line down
+     * in display memory. Display memory below the old start address already
+     * holds the remaining lines, so only their pending dirty spans move up
+     * along with the new bottom line. Once the end of display memory is 
+     * reached the screen is moved back to the top with a full copy.
+     */
+    if (origin + (VGA_HEIGHT + 1) * VGA_WIDTH <= buffer_size)
+    {
+        origin += VGA_WIDTH;
+        memmove(dirty_start, dirty_start + 1, VGA_HEIGHT - 1);
+        memmove(dirty_end, dirty_end + 1, VGA_HEIGHT - 1);
+        dirty_start[VGA_HEIGHT - 1] = 0;
+        dirty_end[VGA_HEIGHT - 1] = VGA_WIDTH;
+    }
+    else
+    {
+        origin = 0;
+        memset(dirty_start, 0, VGA_HEIGHT);
+        memset(dirty_end, VGA_WIDTH, VGA_HEIGHT);
+    }
+}
+
+void kernel::Console::newline()
+{
+    column = 0;
+    if (++row == VGA_HEIGHT)
+    {
+        scroll();
+        row = VGA_HEIGHT - 1;
+    }
+}
+
+void kernel::Console::put(unsigned char c)
+{
+    switch (c)
+    {
+    case '\n':
+        newline();
+        return;
+    case '\r':
+        column = 0;
+        return;
+    case '\t':
+        column = (column + 8) & ~(size_t)7;
+        if (column >= VGA_WIDTH)
+            newline();
+        return;
+    case '\b':
+        if (column > 0)
+            column--;
+        return;
+    }
+
+    shadow[row * VGA_WIDTH + column] = c | (uint16_t)color << 8;
+    mark_dirty(row, column, column + 1);
+    if (++column == VGA_WIDTH)
+    {
+        newline();
+    }
+}
+
+void kernel::Console::flush()
 {
     for (size_t y = 0; y < VGA_HEIGHT; y++)
     {
-        for (size_t x = 0; x < VGA_WIDTH; x++)
+        const size_t start = dirty_start[y];
+        const size_t end = dirty_end[y];
+
+        if (start < end)
         {
-            const size_t index = y * VGA_WIDTH + x;
-            buffer[index] = ' ' | (uint16_t)color << 8;
+            memcpy(buffer + origin + y * VGA_WIDTH + start,
+                   shadow + y * VGA_WIDTH + start,
+                   (end - start) * sizeof(uint16_t));
+            dirty_start[y] = dirty_end[y] = 0;
         }
     }
+
+    if (origin != hw_origin)
+    {
+        update_origin(origin);
+        hw_origin = origin;
+    }
+
+    const size_t cursor = origin + row * VGA_WIDTH + column;
+    if (cursor != hw_cursor)
+    {
+        update_cursor(cursor);
+        hw_cursor = cursor;
+    }
+}
+
+void kernel::Console::clrscr()
+{
+    const uint16_t blank = ' ' | (uint16_t)color << 8;
+
+    for (size_t index = 0; index < VGA_HEIGHT * VGA_WIDTH; index++)
+    {
+        shadow[index] = blank;
+    }
+    memset(dirty_start, 0, VGA_HEIGHT);
+    memset(dirty_end, VGA_WIDTH, VGA_HEIGHT);
+    origin = 0;
     row = 0;
     column = 0;
-    update_cursor(column, row);
+    flush();
 }
 
 int kernel::Console::putchar(int c)
 {
-    unsigned char uc = (unsigned char)c;
-    const size_t index = row * VGA_WIDTH + column;
+    put((unsigned char)c);
+    flush();
 
-    // Check for new line
-    if (uc == '\n')
-    {
-        column = 0;
-        row++;
-    }
-    else
+    return 1;
+}
+
+void kernel::Console::put(const char *s, size_t n)
+{
+    const unsigned char *uc = (const unsigned char *)s;
+    const uint16_t attr = (uint16_t)color << 8;
+    size_t i = 0;
+
+    while (i < n)
     {
+        // Length of the run of printable chars fitting on the current line
+        size_t run = 0;
+        while (run < VGA_WIDTH - column && i + run < n && uc[i + run] >= ' ')
+            run++;
 
-        buffer[index] = uc | (uint16_t)color << 8;
-        if (++column == VGA_WIDTH)
+        if (run == 0)
         {
-            column = 0;
-            if (++row == VGA_HEIGHT)
-            {
-                row = 0;
-            }
-            else
-            {
-                row++;
-            }
+            put(uc[i++]);
+            continue;
         }
+
+        uint16_t *cell = shadow + row * VGA_WIDTH + column;
+        for (size_t k = 0; k < run; k++)
+            cell[k] = uc[i + k] | attr;
+        mark_dirty(row, column, column + run);
+
+        i += run;
+        column += run;
+        if (column == VGA_WIDTH)
+            newline();
     }
-    update_cursor(column, row);
+}
 
-    return 1;
+void kernel::Console::sink(void *ctx, const char *s, size_t n)
+{
+    ((kernel::Console *)ctx)->put(s, n);
 }
 
-int kernel::Console::vprintf(const char *s, va_list args)
+int kernel::Console::write(const char *s, size_t n)
 {
-    int written = 0;
-    size_t size = strlen(s);
-    char buff[size+1];
+    put(s, n);
+    flush();
 
-    vsnprintf(buff, size+1, s, args);
+    return n;
+}
 
-    for (size_t i = 0; i < size; i++)
-    {
-        putchar(buff[i]);
-        written++;
-    }
+int kernel::Console::vprintf(const char *s, va_list args)
+{
+    int written;
+
+    written = kernel::vformat(sink, this, s, args);
+    flush();
 
     return written;
 }
@@ -0,0 +1,425 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include <kernel/format.hpp>
+
+/**
+ * Conversion flags
+ */
+#define FORMAT_LEFT 0x01  // '-' left justify within field
+#define FORMAT_ZERO 0x02  // '0' pad with zeros
+#define FORMAT_PLUS 0x04  // '+' always print sign
+#define FORMAT_SPACE 0x08 // ' ' print space in place of plus sign
+#define FORMAT_ALT 0x10   // '#' alternate form
+#define FORMAT_UPPER 0x20 // upper case hex digits
+
+/**
+ * Formatter output state
+ */
+struct FormatOutput
+{
+    kernel::format_sink_t sink;
+    void *ctx;
+    int count;
+};
+
+/**
+ * Write chars to output sink
+ *
+ * @param out pointer to output state
+ * @param s pointer to first char
+ * @param n number of chars
+ */
+static inline void emit(FormatOutput *out, const char *s, size_t n)
+{
+    if (n)
+    {
+        out->sink(out->ctx, s, n);
+        out->count += n;
+    }
+}
+
+/**
+ * Write a char repeatedly to output sink
+ *
+ * @param out pointer to output state
+ * @param c char to write
+ * @param n number of times to write char
+ */
+static void emit_repeat(FormatOutput *out, char c, int n)
+{
+    static const char spaces[] = "                ";
+    static const char zeros[] = "0000000000000000";
+    const char *fill = c == '0' ? zeros : spaces;
+
+    while (n > 0)
+    {
+        int chunk = n < (int)sizeof(spaces) - 1 ? n : (int)sizeof(spaces) - 1;
+        emit(out, fill, chunk);
+        n -= chunk;
+    }
+}
+
+/**
+ * Write an unsigned integer to output sink
+ *
+ * @param out pointer to output state
+ * @param value integer value
+ * @param base numeric base: 8, 10 or 16
+ * @param sign sign char or zero for no sign
+ * @param flags conversion flags
+ * @param width minimum field width
+ * @param precision minimum number of digits or -1 for default
+ */
+static void emit_number(FormatOutput *out, unsigned long long value, unsigned base,
+                        char sign, int flags, int width, int precision)
+{
+    const char *digits = (flags & FORMAT_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char num[24]; // digits of a 64 bit value in octal
+    int len = 0;
+
+    // Convert digits in reverse order using 32 bit arithmetic when possible
+    if (base == 16)
+    {
+        for (; value; value >>= 4)
+            num[len++] = digits[value & 0xf];
+    }
+    else if (base == 8)
+    {
+        for (; value; value >>= 3)
+            num[len++] = digits[value & 0x7];
+    }
+    else
+    {
+        for (; value >> 32; value /= 10)
+            num[len++] = digits[value % 10];
+        for (uint32_t v = (uint32_t)value; v; v /= 10)
+            num[len++] = digits[v % 10];
+    }
+
+    const char *prefix = "";
+    int prefix_len = 0;
+    if (sign)
+    {
+        prefix = sign == '-' ? "-" : (sign == '+' ? "+" : " ");
+        prefix_len = 1;
+    }
+    else if (flags & FORMAT_ALT)
+    {
+        if (base == 16 && len)
+        {
+            prefix = (flags & FORMAT_UPPER) ? "0X" : "0x";
+            prefix_len = 2;
+        }
+        else if (base == 8 && precision <= len)
+        {
+            // Alternate octal form forces a leading zero
+            precision = len + 1;
+        }
+    }
+
+    // Default precision prints zero as a single digit
+    int zeros = 0;
+    if (precision < 0)
+    {
+        if (len == 0)
+            zeros = 1;
+        if ((flags & (FORMAT_ZERO | FORMAT_LEFT)) == FORMAT_ZERO && width > prefix_len + len + zeros)
+            zeros = width - prefix_len - len;
+    }
+    else if (precision > len)
+    {
+        zeros = precision - len;
+    }
+
+    int pad = width - prefix_len - zeros - len;
+
+    if (!(flags & FORMAT_LEFT))
+        emit_repeat(out, ' ', pad);
+    emit(out, prefix, prefix_len);
+    emit_repeat(out, '0', zeros);
+    while (len)
+    {
+        // Emit digits in forward order in runs to reduce sink calls
+        char run[sizeof(num)];
+        int n = 0;
+        while (len)
+            run[n++] = num[--len];
+        emit(out, run, n);
+    }
+    if (flags & FORMAT_LEFT)
+        emit_repeat(out, ' ', pad);
+}
+
+/**
+ * Write a string to output sink
+ *
+ * @param out pointer to output state
+ * @param s pointer to string
+ * @param flags conversion flags
+ * @param width minimum field width
+ * @param precision maximum number of chars or -1 for no limit
+ */
+static void emit_string(FormatOutput *out, const char *s, int flags, int width, int precision)
+{
+    size_t len = 0;
+
+    if (s == nullptr)
+        s = "(null)";
+    while (s[len] && (precision < 0 || len < (size_t)precision))
+        len++;
+
+    int pad = width - (int)len;
+    if (!(flags & FORMAT_LEFT))
+        emit_repeat(out, ' ', pad);
+    emit(out, s, len);
+    if (flags & FORMAT_LEFT)
+        emit_repeat(out, ' ', pad);
+}
+
+int kernel::vformat(kernel::format_sink_t sink, void *ctx, const char *fmt, va_list args)
+{
+    FormatOutput out = {sink, ctx, 0};
+    const char *p = fmt;
+
+    while (*p)
+    {
+        // Emit literal text up to the next conversion
+        const char *start = p;
+        while (*p && *p != '%')
+            p++;
+        emit(&out, start, p - start);
+        if (*p == '\0')
+            break;
+        const char *directive = p++;
+
+        // Flags
+        int flags = 0;
+        for (;; p++)
+        {
+            if (*p == '-')
+                flags |= FORMAT_LEFT;
+            else if (*p == '0')
+                flags |= FORMAT_ZERO;
+            else if (*p == '+')
+                flags |= FORMAT_PLUS;
+            else if (*p == ' ')
+                flags |= FORMAT_SPACE;
+            else if (*p == '#')
+                flags |= FORMAT_ALT;
+            else
+                break;
+        }
+
+        // Field width
+        int width = 0;
+        if (*p == '*')
+        {
+            width = va_arg(args, int);
+            if (width < 0)
+            {
+                flags |= FORMAT_LEFT;
+                width = -width;
+            }
+            p++;
+        }
+        else
+        {
+            for (; *p >= '0' && *p <= '9'; p++)
+                width = width * 10 + (*p - '0');
+        }
+
+        // Precision
+        int precision = -1;
+        if (*p == '.')
+        {
+            p++;
+            precision = 0;
+            if (*p == '*')
+            {
+                precision = va_arg(args, int);
+                p++;
+            }
+            else
+            {
+                for (; *p >= '0' && *p <= '9'; p++)
+                    precision = precision * 10 + (*p - '0');
+            }
+        }
+
+        // Length modifier
+        int size = 0; // -2: hh, -1: h, 0: int, 1: l, 2: ll
+        for (;; p++)
+        {
+            if (*p == 'h')
+                size--;
+            else if (*p == 'l')
+                size++;
+            else if (*p == 'z')
+                size = sizeof(size_t) == sizeof(long) ? 1 : 2;
+            else
+                break;
+        }
+
+        // Conversion
+        char conv = *p;
+        if (conv == '\0')
+            break;
+        p++;
+
+        switch (conv)
+        {
+        case 'd':
+        case 'i':
+        {
+            long long value;
+            if (size >= 2)
+                value = va_arg(args, long long);
+            else if (size == 1)
+                value = va_arg(args, long);
+            else
+                value = va_arg(args, int);
+            if (size == -1)
+                value = (short)value;
+            else if (size <= -2)
+                value = (signed char)value;
+
+            char sign = 0;
+            if (value < 0)
+                sign = '-';
+            else if (flags & FORMAT_PLUS)
+                sign = '+';
+            else if (flags & FORMAT_SPACE)
+                sign = ' ';
+
+            unsigned long long magnitude = value < 0 ? -(unsigned long long)value : value;
+            emit_number(&out, magnitude, 10, sign, flags, width, precision);
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        {
+            unsigned long long value;
+            if (size >= 2)
+                value = va_arg(args, unsigned long long);
+            else if (size == 1)
+                value = va_arg(args, unsigned long);
+            else
+                value = va_arg(args, unsigned int);
+            if (size == -1)
+                value = (unsigned short)value;
+            else if (size <= -2)
+                value = (unsigned char)value;
+
+            if (conv == 'X')
+                flags |= FORMAT_UPPER;
+            unsigned base = conv == 'u' ? 10 : (conv == 'o' ? 8 : 16);
+            emit_number(&out, value, base, 0, flags, width, precision);
+            break;
+        }
+        case 'p':
+        {
+            uintptr_t value = (uintptr_t)va_arg(args, void *);
+            emit(&out, "0x", 2);
+            emit_number(&out, value, 16, 0, FORMAT_ZERO, 2 * sizeof(void *), -1);
+            break;
+        }
+        case 's':
+            emit_string(&out, va_arg(args, const char *), flags, width, precision);
+            break;
+        case 'c':
+        {
+            char c = (char)va_arg(args, int);
+            if (!(flags & FORMAT_LEFT))
+                emit_repeat(&out, ' ', width - 1);
+            emit(&out, &c, 1);
+            if (flags & FORMAT_LEFT)
+                emit_repeat(&out, ' ', width - 1);
+            break;
+        }
+        case '%':
+            emit(&out, "%", 1);
+            break;
+        default:
+            // Unknown conversion is written out as is, from the '%' on
+            emit(&out, directive, p - directive);
+            break;
+        }
+    }
+
+    return out.count;
+}
+
+int kernel::format(kernel::format_sink_t sink, void *ctx, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vformat(sink, ctx, fmt, ap);
+    va_end(ap);
+
+    return n;
+}
+
+/**
+ * Bounded buffer sink state
+ */
+struct BufferSink
+{
+    char *buf;
+    size_t size; // space left excluding null terminator
+};
+
+/**
+ * Sink copying output into a bounded buffer and dropping the overflow
+ *
+ * @param ctx pointer to buffer sink state
+ * @param s pointer to first char
+ * @param n number of chars
+ */
+static void buffer_sink(void *ctx, const char *s, size_t n)
+{
+    BufferSink *b = (BufferSink *)ctx;
+
+    if (n > b->size)
+        n = b->size;
+    for (size_t i = 0; i < n; i++)
+        b->buf[i] = s[i];
+    b->buf += n;
+    b->size -= n;
+}
+
+/**
+ * Sink discarding output. Used to measure output length.
+ */
+static void null_sink(void *, const char *, size_t)
+{
+}
+
+int kernel::vsnformat(char *buf, size_t size, const char *fmt, va_list args)
+{
+    if (buf == nullptr || size == 0)
+        return vformat(null_sink, nullptr, fmt, args);
+
+    BufferSink b = {buf, size - 1};
+    int n = vformat(buffer_sink, &b, fmt, args);
+    *b.buf = '\0';
+
+    return n;
+}
+
+int kernel::snformat(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnformat(buf, size, fmt, ap);
+    va_end(ap);
+
+    return n;
+}
@@ -0,0 +1,550 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <kernel/frame.hpp>
+#include <kernel/ioport.hpp>
+#include <kernel/logging.hpp>
+
+/** Number of frames reachable through the kernel direct map */
+#define FRAME_MAX PFN(LOWMEM_SIZE)
+
+/** Maximum number of usable and reserved memory ranges tracked at boot */
+#define FRAME_MAX_RANGES 32
+
+//-----------------------------------------------
+//	Hot frame list
+//-----------------------------------------------
+
+#define FRAME_HOT_HIGH 64  // frames kept before returning a batch
+#define FRAME_HOT_BATCH 16 // frames moved to or from the free lists at once
+
+//-----------------------------------------------
+//	Frame flags
+//-----------------------------------------------
+
+#define FRAME_FREE 0x01     // first frame of a free block in a free list
+#define FRAME_RESERVED 0x02 // not usable RAM, never freed
+
+/** Address past the kernel image, defined in the linker script */
+extern "C" char end[];
+
+/**
+ * Frame descriptor
+ */
+struct Frame
+{
+    Frame *next;   /**< Next block in free list or hot list */
+    Frame *prev;   /**< Previous block in free list */
+    uint8_t order; /**< Order of the free block starting at this frame */
+    uint8_t flags; /**< Frame flags */
+};
+
+/**
+ * Free list of blocks of one order
+ */
+struct FreeArea
+{
+    Frame *head;    /**< First free block */
+    size_t nr_free; /**< Number of free blocks */
+};
+
+/**
+ * Hot frame list. Holds single frames in LIFO order so the most recently
+ * freed frame, likely still in the processor cache, is reused first.
+ *
+ * This is a uniprocessor kernel, so the list belongs to the only CPU.
+ */
+struct HotList
+{
+    Frame *head;  /**< Most recently freed frame */
+    size_t count; /**< Number of frames */
+};
+
+/**
+ * Physical memory range in frames
+ */
+struct FrameRange
+{
+    uint32_t start; /**< First frame */
+    uint32_t end;   /**< Frame past the range */
+};
+
+/**
+ * Descriptor of every frame below `max_frame`
+ */
+static Frame *frames = nullptr;
+static size_t max_frame = 0;
+
+static FreeArea free_area[FRAME_MAX_ORDER + 1];
+static HotList hot;
+static kernel::FrameStats stats;
+
+static inline size_t frame_index(Frame *frame)
+{
+    return frame - frames;
+}
+
+static inline uintptr_t frame_addr(Frame *frame)
+{
+    return (uintptr_t)frame_index(frame) << PAGE_SHIFT;
+}
+
+static void list_add(Frame *frame, uint32_t order)
+{
+    FreeArea *area = &free_area[order];
+
+    frame->prev = nullptr;
+    frame->next = area->head;
+    if (area->head != nullptr)
+        area->head->prev = frame;
+    area->head = frame;
+    area->nr_free++;
+
+    frame->order = order;
+    frame->flags |= FRAME_FREE;
+}
+
+static void list_del(Frame *frame, uint32_t order)
+{
+    FreeArea *area = &free_area[order];
+
+    if (frame->prev != nullptr)
+        frame->prev->next = frame->next;
+    else
+        area->head = frame->next;
+    if (frame->next != nullptr)
+        frame->next->prev = frame->prev;
+    area->nr_free--;
+
+    frame->next = nullptr;
+    frame->prev = nullptr;
+    frame->flags &= ~FRAME_FREE;
+}
+
+/**
+ * Return a block to the free lists merging it with its free buddies.
+ * Must be called with interrupts disabled.
+ *
+ * @param index first frame of the block
+ * @param order block order
+ */
+static void free_block(size_t index, uint32_t order)
+{
+    stats.nr_free += 1u << order;
+
+    while (order < FRAME_MAX_ORDER)
+    {
+        size_t buddy = index ^ (1u << order);
+        if (buddy >= max_frame)
+            break;
+
+        Frame *frame = &frames[buddy];
+        if (!(frame->flags & FRAME_FREE) || frame->order != order)
+            break;
+
+        list_del(frame, order);
+        index &= ~(1u << order);
+        order++;
+    }
+
+    list_add(&frames[index], order);
+}
+
+/**
+ * Take a block from the free lists splitting a larger one if needed. Must
+ * be called with interrupts disabled.
+ *
+ * @param order block order
+ * @returns first frame of the block or nullptr if out of memory
+ */
+static Frame *alloc_block(uint32_t order)
+{
+    uint32_t current = order;
+
+    while (current <= FRAME_MAX_ORDER && free_area[current].head == nullptr)
+        current++;
+    if (current > FRAME_MAX_ORDER)
+    {
+        stats.failures++;
+        return nullptr;
+    }
+
+    Frame *frame = free_area[current].head;
+    list_del(frame, current);
+
+    // Give back the upper halves
+    while (current > order)
+    {
+        current--;
+        list_add(frame + (1u << current), current);
+    }
+
+    stats.nr_free -= 1u << order;
+    return frame;
+}
+
+/**
+ * Free a run of frames as the largest aligned blocks fitting into it.
+ * Must be called with interrupts disabled.
+ *
+ * @param start first frame
+ * @param end frame past the run
+ */
+static void free_run(size_t start, size_t end)
+{
+    while (start < end)
+    {
+        uint32_t order = 0;
+        while (order < FRAME_MAX_ORDER && !(start & (1u << order)) && start + (2u << order) <= end)
+            order++;
+
+        free_block(start, order);
+        stats.frees++;
+        start += 1u << order;
+    }
+}
+
+/**
+ * Add a range to a range list
+ *
+ * @param ranges range list
+ * @param count pointer to number of ranges in list
+ * @param start first frame
+ * @param end frame past the range
+ */
+static void add_range(FrameRange *ranges, size_t *count, uint64_t start, uint64_t end)
+{
+    if (end > FRAME_MAX)
+        end = FRAME_MAX;
+    if (start >= end || *count >= FRAME_MAX_RANGES)
+        return;
+
+    ranges[*count].start = start;
+    ranges[*count].end = end;
+    (*count)++;
+}
+
+/**
+ * Add a reserved physical address range, widened to whole frames
+ *
+ * @param ranges range list
+ * @param count pointer to number of ranges in list
+ * @param addr start address
+ * @param size size in bytes
+ */
+static void reserve(FrameRange *ranges, size_t *count, uint64_t addr, uint64_t size)
+{
+    add_range(ranges, count, PFN(addr), PFN(addr + size + PAGE_SIZE - 1));
+}
+
+/**
+ * Find the lowest range of a list overlapping a frame range
+ *
+ * @param ranges range list
+ * @param count number of ranges in list
+ * @param start first frame
+ * @param end frame past the range
+ * @returns overlapping range or nullptr if none
+ */
+static FrameRange *find_overlap(FrameRange *ranges, size_t count, size_t start, size_t end)
+{
+    FrameRange *first = nullptr;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (ranges[i].start < end && ranges[i].end > start && (first == nullptr || ranges[i].start < first->start))
+            first = &ranges[i];
+    }
+    return first;
+}
+
+int kernel::PageFrame::init(boot::MultibootInfo *multiboot_info)
+{
+    FrameRange usable[FRAME_MAX_RANGES];
+    FrameRange reserved[FRAME_MAX_RANGES];
+    size_t nr_usable = 0;
+    size_t nr_reserved = 0;
+
+    if (!(multiboot_info->flags & MULTIBOOT_INFO_MEM_MAP))
+        return -1;
+
+    // Collect usable RAM regions
+    uintptr_t mmap = (uintptr_t)phys_to_virt(multiboot_info->mmap_addr);
+    uintptr_t mmap_end = mmap + multiboot_info->mmap_length;
+    while (mmap < mmap_end)
+    {
+        boot::MultibootMmapEntry *entry = (boot::MultibootMmapEntry *)mmap;
+        if (entry->type == MULTIBOOT_MEMORY_AVAILABLE)
+            add_range(usable, &nr_usable, PFN(entry->addr + PAGE_SIZE - 1), PFN(entry->addr + entry->len));
+        mmap += entry->size + sizeof(entry->size);
+    }
+
+    // Frame 0 doubles as the out of memory result
+    reserve(reserved, &nr_reserved, 0, virt_to_phys(end));
+
+    // Boot information still in use by the kernel
+    reserve(reserved, &nr_reserved, virt_to_phys(multiboot_info), sizeof(*multiboot_info));
+    reserve(reserved, &nr_reserved, multiboot_info->mmap_addr, multiboot_info->mmap_length);
+    if (multiboot_info->flags & MULTIBOOT_INFO_CMDLINE)
+        reserve(reserved, &nr_reserved, multiboot_info->cmdline,
+                strlen((const char *)phys_to_virt(multiboot_info->cmdline)) + 1);
+    if (multiboot_info->flags & MULTIBOOT_INFO_MODS)
+    {
+        boot::MultibootModule *mods = (boot::MultibootModule *)phys_to_virt(multiboot_info->mods_addr);
+
+        reserve(reserved, &nr_reserved, multiboot_info->mods_addr, multiboot_info->mods_count * sizeof(*mods));
+        for (uint32_t i = 0; i < multiboot_info->mods_count; i++)
+        {
+            reserve(reserved, &nr_reserved, mods[i].mod_start, mods[i].mod_end - mods[i].mod_start);
+            if (mods[i].string)
+                reserve(reserved, &nr_reserved, mods[i].string, strlen((const char *)phys_to_virt(mods[i].string)) + 1);
+        }
+    }
+
+    for (size_t i = 0; i < nr_usable; i++)
+    {
+        if (usable[i].end > max_frame)
+            max_frame = usable[i].end;
+    }
+
+    /**
+     * Place the frame descriptors in the first usable gap large enough.
+     * Only the memory mapped by the boot page tables is accessible yet.
+     */
+    size_t size = PFN(PAGE_ALIGN(max_frame * sizeof(Frame)));
+    for (size_t i = 0; i < nr_usable && frames == nullptr; i++)
+    {
+        size_t start = usable[i].start;
+        size_t stop = usable[i].end < PFN(BOOT_MAPPED_SIZE) ? usable[i].end : PFN(BOOT_MAPPED_SIZE);
+        while (start + size <= stop)
+        {
+            FrameRange *overlap = find_overlap(reserved, nr_reserved, start, start + size);
+            if (overlap == nullptr)
+            {
+                frames = (Frame *)phys_to_virt((uintptr_t)start << PAGE_SHIFT);
+                reserve(reserved, &nr_reserved, (uintptr_t)start << PAGE_SHIFT, size << PAGE_SHIFT);
+                break;
+            }
+            start = overlap->end;
+        }
+    }
+    if (frames == nullptr)
+        return -1;
+
+    for (size_t i = 0; i < max_frame; i++)
+    {
+        frames[i].next = nullptr;
+        frames[i].prev = nullptr;
+        frames[i].order = 0;
+        frames[i].flags = FRAME_RESERVED;
+    }
+
+    // Free the usable frames not reserved
+    for (size_t i = 0; i < nr_usable; i++)
+    {
+        size_t start = usable[i].start;
+        while (start < usable[i].end)
+        {
+            FrameRange *overlap = find_overlap(reserved, nr_reserved, start, usable[i].end);
+            size_t stop = overlap ? (overlap->start > start ? overlap->start : start) : usable[i].end;
+
+            for (size_t frame = start; frame < stop; frame++)
+                frames[frame].flags = 0;
+            free_run(start, stop);
+
+            start = overlap ? overlap->end : usable[i].end;
+        }
+    }
+
+    stats.nr_total = stats.nr_free;
+    stats.frees = 0;
+
+    LOG_INFO("frame", "%lu KiB available\n", (unsigned long)(stats.nr_total * (PAGE_SIZE / 1024)));
+    return 0;
+}
+
+uintptr_t kernel::PageFrame::alloc()
+{
+    unsigned long flags = kernel::irq_save();
+
+    // Refill the hot list with a batch of frames
+    if (hot.count == 0)
+    {
+        for (size_t i = 0; i < FRAME_HOT_BATCH; i++)
+        {
+            Frame *frame = alloc_block(0);
+            if (frame == nullptr)
+                break;
+            frame->next = hot.head;
+            hot.head = frame;
+            hot.count++;
+            stats.nr_free++;
+            stats.allocs++;
+        }
+    }
+
+    uintptr_t addr = 0;
+    if (hot.count)
+    {
+        Frame *frame = hot.head;
+        hot.head = frame->next;
+        hot.count--;
+        frame->next = nullptr;
+
+        // Hot frames are accounted free until handed out
+        stats.nr_free--;
+        stats.hot_hits++;
+        addr = frame_addr(frame);
+    }
+
+    kernel::irq_restore(flags);
+    return addr;
+}
+
+void kernel::PageFrame::free(uintptr_t addr)
+{
+    unsigned long flags = kernel::irq_save();
+
+    Frame *frame = &frames[PFN(addr)];
+    frame->next = hot.head;
+    hot.head = frame;
+    hot.count++;
+    stats.nr_free++;
+
+    // Return the coldest frames to the free lists
+    if (hot.count > FRAME_HOT_HIGH)
+    {
+        Frame **link = &hot.head;
+        for (size_t i = 0; i < FRAME_HOT_HIGH - FRAME_HOT_BATCH; i++)
+            link = &(*link)->next;
+
+        Frame *cold = *link;
+        *link = nullptr;
+        hot.count = FRAME_HOT_HIGH - FRAME_HOT_BATCH;
+
+        while (cold != nullptr)
+        {
+            Frame *next = cold->next;
+            cold->next = nullptr;
+            stats.nr_free--;
+            free_block(frame_index(cold), 0);
+            stats.frees++;
+            cold = next;
+        }
+    }
+
+    kernel::irq_restore(flags);
+}
+
+uintptr_t kernel::PageFrame::alloc_pages(uint32_t order)
+{
+    if (order > FRAME_MAX_ORDER)
+        return 0;
+
+    unsigned long flags = kernel::irq_save();
+
+    Frame *frame = alloc_block(order);
+    if (frame != nullptr)
+        stats.allocs++;
+
+    kernel::irq_restore(flags);
+    return frame ? frame_addr(frame) : 0;
+}
+
+void kernel::PageFrame::free_pages(uintptr_t addr, uint32_t order)
+{
+    unsigned long flags = kernel::irq_save();
+
+    free_block(PFN(addr), order);
+    stats.frees++;
+
+    kernel::irq_restore(flags);
+}
+
+uintptr_t kernel::PageFrame::alloc_contiguous(size_t count, size_t align)
+{
+    size_t size = count > align ? count : align;
+    uint32_t order = 0;
+
+    while ((1u << order) < size)
+        order++;
+    if (count == 0 || order > FRAME_MAX_ORDER)
+        return 0;
+
+    unsigned long flags = kernel::irq_save();
+
+    // Blocks are aligned on their size
+    Frame *frame = alloc_block(order);
+    if (frame != nullptr)
+    {
+        size_t index = frame_index(frame);
+        stats.allocs++;
+        free_run(index + count, index + (1u << order));
+    }
+
+    kernel::irq_restore(flags);
+    return frame ? frame_addr(frame) : 0;
+}
+
+void kernel::PageFrame::free_contiguous(uintptr_t addr, size_t count)
+{
+    unsigned long flags = kernel::irq_save();
+
+    free_run(PFN(addr), PFN(addr) + count);
+
+    kernel::irq_restore(flags);
+}
+
+size_t kernel::PageFrame::get_free()
+{
+    return stats.nr_free;
+}
+
+size_t kernel::PageFrame::get_total()
+{
+    return stats.nr_total;
+}
+
+uintptr_t kernel::PageFrame::get_limit()
+{
+    return (uintptr_t)max_frame << PAGE_SHIFT;
+}
+
+void kernel::PageFrame::get_stats(kernel::FrameStats *s)
+{
+    unsigned long flags = kernel::irq_save();
+
+    *s = stats;
+    s->nr_hot = hot.count;
+    for (uint32_t order = 0; order <= FRAME_MAX_ORDER; order++)
+        s->nr_blocks[order] = free_area[order].nr_free;
+
+    kernel::irq_restore(flags);
+}
+
+void kernel::PageFrame::dump_stats(kernel::format_sink_t sink, void *ctx)
+{
+    kernel::FrameStats s;
+
+    get_stats(&s);
+
+    format(sink, ctx, "frames: %lu free of %lu, %lu hot\n", (unsigned long)s.nr_free, (unsigned long)s.nr_total,
+           (unsigned long)s.nr_hot);
+    format(sink, ctx, "allocs: %lu, frees: %lu, hot hits: %lu, failures: %lu\n", (unsigned long)s.allocs,
+           (unsigned long)s.frees, (unsigned long)s.hot_hits, (unsigned long)s.failures);
+    format(sink, ctx, "order     blocks  unusable\n");
+
+    // Free frames in the free lists, hot frames only serve single frames
+    size_t listed = s.nr_free - s.nr_hot;
+    size_t usable = listed;
+    for (uint32_t order = 0; order <= FRAME_MAX_ORDER; order++)
+    {
+        // Share of free memory in blocks below this order, in thousandths
+        unsigned long unusable = listed ? (unsigned long)((uint64_t)(listed - usable) * 1000 / listed) : 0;
+
+        format(sink, ctx, "%5lu %10lu %5lu.%03lu\n", (unsigned long)order, (unsigned long)s.nr_blocks[order],
+               unusable / 1000, unusable % 1000);
+        usable -= s.nr_blocks[order] << order;
+    }
+}
@@ -1,13 +1,85 @@
 #include <stdint.h>
 
+#include <kernel/ioport.hpp>
 #include <kernel/panic.hpp>
 #include <kernel/isr.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/time.hpp>
+
+/**
+ * Registered interrupt handler and its context
+ */
+struct ISRAction
+{
+    kernel::isr_handler_t handler;
+    void *ctx;
+};
+
+/**
+ * Interrupt vector entry holding the chain of handlers sharing the
+ * interrupt in a compact array.
+ */
+struct ISRVector
+{
+    uint32_t count;                    // number of registered handlers
+    uint32_t unhandled;                // interrupts no handler claimed
+    ISRAction actions[IVT_MAX_SHARED]; // handlers in registration order
+};
 
 /**
  * Array of interrupt vectors mapping interrupt numbers to corresponding
  * handlers.
  */
-static kernel::isr_handler_t vector[IVT_MAX_VECTORS];
+static ISRVector vector[IVT_MAX_VECTORS];
+
+/**
+ * Interrupt handling statistics. Kept apart from the vectors so dispatch
+ * only touches the handler chain and a single statistics entry.
+ */
+static kernel::ISRStats stats[IVT_MAX_VECTORS];
+
+/**
+ * Number of interrupt handlers running on the current call chain,
+ * including nested interrupts
+ */
+static uint32_t depth = 0;
+
+/**
+ * Deepest interrupt nesting seen
+ */
+static uint32_t max_depth = 0;
+
+/**
+ * Nesting depths tracked for nested interrupt time
+ */
+#define ISR_MAX_DEPTH 32
+
+/**
+ * Cycles spent in interrupts nested inside the handler running at each
+ * depth. Excluded from that handler's duration, so no cycle is billed to
+ * two vectors.
+ */
+static uint64_t nested_cycles[ISR_MAX_DEPTH];
+
+/**
+ * Account an interrupt handling duration.
+ * 
+ * @param s pointer to vector statistics
+ * @param cycles handling duration in cycles
+ */
+static inline void account(kernel::ISRStats *s, uint32_t cycles)
+{
+    uint32_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+
+    if (bucket >= IVT_STATS_BUCKETS)
+        bucket = IVT_STATS_BUCKETS - 1;
+
+    s->count++;
+    s->total_cycles += cycles;
+    if (cycles > s->max_cycles)
+        s->max_cycles = cycles;
+    s->histogram[bucket]++;
+}
 
 /**
  * Default interrupt handler
@@ -19,19 +91,81 @@ static kernel::isr_handler_t vector[IVT_MAX_VECTORS];
  */
 static void isr_default_handler(kernel::ISRFrame *const frame)
 {
-    kernel::panic("*** [ERROR] isr_default_handler: Unhandled Interrupt [%d]", frame->n);
+    kernel::panic("*** [ERROR] isr_default_handler: Unhandled Interrupt [%lu]", (unsigned long)frame->n);
 }
 
 void kernel::IVT::isr_entry(kernel::ISRFrame *const frame)
 {
-    /** TODO: Stack handling for recursive interrupts */
+    if (!isr_enter(frame))
+    {
+        return;
+    }
 
     if (frame->n < IVT_MAX_VECTORS)
     {
-        if (vector[frame->n] != nullptr)
+        ISRVector *v = &vector[frame->n];
+
+        if (v->count)
         {
-            vector[frame->n](frame);
+            int result = IRQ_NONE;
+            uint64_t start = get_cycles();
+
+            const bool nested = irq_nestable(frame);
+
+            /**
+             * Let higher priority interrupts preempt the handlers. Nested
+             * interrupts run on the interrupt stack the arch entry code
+             * switched to.
+             */
+            const uint32_t level = ++depth;
+            if (depth > max_depth)
+            {
+                max_depth = depth;
+            }
+            if (level < ISR_MAX_DEPTH)
+            {
+                nested_cycles[level] = 0;
+            }
+            if (nested)
+            {
+                sti();
+            }
+            for (uint32_t i = 0; i < v->count; i++)
+            {
+                result |= v->actions[i].handler(frame, v->actions[i].ctx);
+            }
+            if (nested)
+            {
+                cli();
+            }
+            if (result == IRQ_NONE)
+            {
+                v->unhandled++;
+            }
             isr_exit(frame);
+            depth--;
+
+            // Bill nested interrupts to their own vectors only
+            uint64_t elapsed = get_cycles() - start;
+            if (depth < ISR_MAX_DEPTH)
+            {
+                nested_cycles[depth] += elapsed;
+            }
+            if (level < ISR_MAX_DEPTH)
+            {
+                elapsed -= nested_cycles[level];
+            }
+            account(&stats[frame->n], (uint32_t)elapsed);
+
+            /**
+             * Run deferred work on exit from the outermost interrupt. Work 
+             * is left pending if the interrupted context had interrupts
+             * disabled, e.g. for an exception raised in a critical section.
+             */
+            if (depth == 0 && irqs_enabled(frame))
+            {
+                SoftIRQ::run();
+            }
         }
         else
         {
@@ -44,10 +178,112 @@ void kernel::IVT::isr_entry(kernel::ISRFrame *const frame)
     }
 }
 
-void kernel::IVT::register_isr(const uint32_t n, kernel::isr_handler_t isr)
+bool kernel::IVT::in_interrupt()
+{
+    return depth > 0;
+}
+
+int kernel::IVT::register_isr(const uint32_t n, kernel::isr_handler_t isr, void *ctx)
+{
+    int ret = -1;
+
+    if (n < IVT_MAX_VECTORS)
+    {
+        unsigned long flags = irq_save();
+
+        ISRVector *v = &vector[n];
+        if (v->count < IVT_MAX_SHARED)
+        {
+            v->actions[v->count].handler = isr;
+            v->actions[v->count].ctx = ctx;
+            v->count++;
+            ret = 0;
+        }
+
+        irq_restore(flags);
+    }
+
+    return ret;
+}
+
+int kernel::IVT::unregister_isr(const uint32_t n, kernel::isr_handler_t isr, void *ctx)
 {
+    int ret = -1;
+
     if (n < IVT_MAX_VECTORS)
     {
-        vector[n] = isr;
+        unsigned long flags = irq_save();
+
+        ISRVector *v = &vector[n];
+        for (uint32_t i = 0; i < v->count; i++)
+        {
+            if (v->actions[i].handler == isr && v->actions[i].ctx == ctx)
+            {
+                // Keep the chain compact and in registration order
+                for (; i + 1 < v->count; i++)
+                {
+                    v->actions[i] = v->actions[i + 1];
+                }
+                v->count--;
+                ret = 0;
+                break;
+            }
+        }
+
+        irq_restore(flags);
+    }
+
+    return ret;
+}
+
+uint32_t kernel::IVT::get_unhandled(const uint32_t n)
+{
+    return n < IVT_MAX_VECTORS ? vector[n].unhandled : 0;
+}
+
+int kernel::IVT::get_stats(const uint32_t n, kernel::ISRStats *stats)
+{
+    if (n >= IVT_MAX_VECTORS)
+    {
+        return -1;
+    }
+
+    unsigned long flags = irq_save();
+    *stats = ::stats[n];
+    irq_restore(flags);
+
+    return 0;
+}
+
+uint32_t kernel::IVT::get_max_depth()
+{
+    return max_depth;
+}
+
+void kernel::IVT::dump_stats(kernel::format_sink_t sink, void *ctx)
+{
+    format(sink, ctx, "max interrupt nesting depth: %lu\n", (unsigned long)max_depth);
+    format(sink, ctx, "vector      count    avg cycles    max cycles  histogram (log2 cycles:count)\n");
+
+    for (uint32_t n = 0; n < IVT_MAX_VECTORS; n++)
+    {
+        kernel::ISRStats s;
+
+        get_stats(n, &s);
+        if (s.count == 0)
+        {
+            continue;
+        }
+
+        format(sink, ctx, "%6lu %10lu %13llu %13lu ", (unsigned long)n, (unsigned long)s.count,
+               s.total_cycles / s.count, (unsigned long)s.max_cycles);
+        for (uint32_t k = 0; k < IVT_STATS_BUCKETS; k++)
+        {
+            if (s.histogram[k])
+            {
+                format(sink, ctx, " %lu:%lu", (unsigned long)k, (unsigned long)s.histogram[k]);
+            }
+        }
+        format(sink, ctx, "\n");
     }
 }
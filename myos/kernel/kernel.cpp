@@ -2,11 +2,41 @@
 
 #include <kernel/setup.hpp>
 #include <kernel/printf.hpp>
-
-#include <i386/pit.hpp>
+#include <kernel/kmsg.hpp>
+#include <kernel/logging.hpp>
+#include <kernel/serial.hpp>
+#include <kernel/tty.hpp>
+#include <kernel/keyboard.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/time.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/frame.hpp>
+#include <kernel/paging.hpp>
+#include <kernel/slab.hpp>
 
 using namespace kernel;
 
+/** Period of the tick count debug message in ticks */
+#define TICK_REPORT_PERIOD 100
+
+static void report_ticks(unsigned long data);
+
+/**
+ * Timer printing the tick count
+ */
+static Timer tick_timer(report_ticks, 0);
+
+/**
+ * Print the tick count and rearm the tick count timer.
+ * 
+ * @param data unused
+ */
+static void report_ticks(unsigned long data)
+{
+	LOG_DEBUG("kernel", "ticks = %lu\n", (unsigned long)get_ticks());
+	mod_timer(&tick_timer, tick_timer.expires + TICK_REPORT_PERIOD);
+}
+
 /**
  * Kernel start entry point.
  * 
@@ -14,19 +44,63 @@ using namespace kernel;
  */
 extern "C" void start_kernel(boot::MultibootInfo *multiboot_info)
 {
+	// Apply kernel command line options
+	if (multiboot_info->flags & MULTIBOOT_INFO_CMDLINE)
+	{
+		Log::parse_cmdline((const char *)phys_to_virt(multiboot_info->cmdline));
+	}
+
+	// Setup physical memory allocator
+	if (PageFrame::init(multiboot_info))
+	{
+		LOG_WARN("frame", "no memory map provided by boot loader\n");
+	}
+
+	// Map physical memory into the kernel address space
+	if (Paging::init())
+	{
+		LOG_WARN("paging", "out of memory mapping physical memory\n");
+	}
+
+	// Setup kernel object caches
+	kmem_cache_init();
+
 	// Setup arch
 	arch_setup();
 
+	// Seed the wall clock
+	clock_init();
+
+	// Setup serial console
+	if (serial1.init(SERIAL_COM1, SERIAL_BAUD))
+	{
+		LOG_WARN("serial", "COM1 not found\n");
+	}
+
+	// Attach terminals to console devices
+	tty_init();
+
+	// Setup keyboard
+	if (Keyboard::init())
+	{
+		LOG_WARN("keyboard", "PS/2 controller not found\n");
+	}
+
 	printf("Hello, kernel World!\n");
 
-	uint32_t last_tick = I386::PIT::get_ticks();
+	// Start kernel timers
+	timer_init();
+	mod_timer(&tick_timer, get_ticks() + TICK_REPORT_PERIOD);
 
 	while (true)
 	{
-		if (I386::PIT::get_ticks() - last_tick > 100)
-		{
-			last_tick = I386::PIT::get_ticks();
-			printf("[KERNEL] ticks = %d\n", last_tick);
-		}
+		// Run deferred work left over by interrupt exits
+		SoftIRQ::run();
+
+		// Write out pending kernel messages
+		KMsg::drain();
+
+		// Sleep until the next timer deadline
+		Tick::idle();
 	}
 }
@@ -0,0 +1,234 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include <kernel/tty.hpp>
+#include <kernel/format.hpp>
+#include <kernel/time.hpp>
+#include <kernel/kmsg.hpp>
+#include <kernel/logging.hpp>
+
+/**
+ * Record states
+ *
+ * A record is free until its producer commits it. Padding records fill
+ * the unused space at the end of the ring when a record does not fit
+ * before the wrap around.
+ */
+#define KMSG_FREE 0
+#define KMSG_COMMITTED 1
+#define KMSG_PADDING 2
+
+/**
+ * Message record header
+ *
+ * Records are laid out back to back in the ring with their text stored
+ * right after the header. The size of each record is a multiple of the
+ * header size so a padding record always fits in the space left at the
+ * end of the ring. The header is padded to a power of two size.
+ */
+struct KMsgRecord
+{
+    uint16_t size;      /**< Size of record including header */
+    uint16_t len;       /**< Length of the message text */
+    uint8_t state;      /**< Record state */
+    uint8_t level;      /**< Log level of message */
+    uint16_t reserved;  /**< Unused */
+    uint64_t timestamp; /**< Monotonic nanoseconds when logged */
+    const char *tag;    /**< Subsystem tag or nullptr */
+    char text[];        /**< Message text */
+} __attribute__((aligned(32)));
+
+/**
+ * Ring buffer of message records.
+ *
+ * The head and tail are free running byte positions. Producers advance
+ * the head to reserve space while the single draining context advances
+ * the tail after clearing the consumed records.
+ */
+static struct
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    uint32_t draining;
+    char __attribute__((aligned(32))) data[KMSG_BUFSIZ];
+} ring;
+
+/**
+ * Get record at a ring position
+ *
+ * @param pos free running ring position
+ * @returns pointer to record
+ */
+static inline KMsgRecord *record_at(uint32_t pos)
+{
+    return (KMsgRecord *)&ring.data[pos & (KMSG_BUFSIZ - 1)];
+}
+
+/**
+ * Reserve space for a record in the ring.
+ *
+ * @param size size of record including header
+ * @returns pointer to reserved record or nullptr if the ring is full
+ */
+static KMsgRecord *reserve(uint32_t size)
+{
+    uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);
+    uint32_t pad;
+
+    do
+    {
+        uint32_t room = KMSG_BUFSIZ - (head & (KMSG_BUFSIZ - 1));
+        uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+
+        pad = room < size ? room : 0;
+        if (head + pad + size - tail > KMSG_BUFSIZ)
+        {
+            __atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        }
+    } while (!__atomic_compare_exchange_n(&ring.head, &head, head + pad + size, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    if (pad)
+    {
+        KMsgRecord *padding = record_at(head);
+        padding->size = pad;
+        __atomic_store_n(&padding->state, KMSG_PADDING, __ATOMIC_RELEASE);
+    }
+
+    return record_at(head + pad);
+}
+
+/**
+ * Write drained message text to the console devices
+ *
+ * @param s pointer to first char
+ * @param n number of chars
+ */
+static void emit(const char *s, size_t n)
+{
+    kernel::ttys[TTY_CONSOLE].write(s, n);
+    kernel::ttys[TTY_SERIAL].write(s, n);
+}
+
+int kernel::KMsg::vlog(int level, const char *tag, const char *fmt, va_list args)
+{
+    va_list args_copy;
+    KMsgRecord *record;
+    uint32_t size;
+    int n;
+
+    // Measure message length
+    va_copy(args_copy, args);
+    n = kernel::vsnformat(nullptr, 0, fmt, args_copy);
+    va_end(args_copy);
+
+    if (n <= 0)
+        return 0;
+    if (n > KMSG_TEXT_MAX)
+        n = KMSG_TEXT_MAX;
+
+    size = sizeof(KMsgRecord) + n + 1;
+    size = (size + sizeof(KMsgRecord) - 1) & ~(sizeof(KMsgRecord) - 1);
+
+    record = reserve(size);
+    if (record == nullptr)
+        return 0;
+
+    record->size = size;
+    record->len = n;
+    record->level = level;
+    record->tag = tag;
+    record->timestamp = kernel::ktime_get_ns();
+    kernel::vsnformat(record->text, n + 1, fmt, args);
+
+    __atomic_store_n(&record->state, KMSG_COMMITTED, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+int kernel::KMsg::log(int level, const char *tag, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vlog(level, tag, fmt, ap);
+    va_end(ap);
+
+    return n;
+}
+
+size_t kernel::KMsg::drain()
+{
+    static bool line_start = true;
+    static uint32_t reported_drops = 0;
+    size_t count = 0;
+
+    if (__atomic_exchange_n(&ring.draining, 1, __ATOMIC_ACQUIRE))
+        return 0;
+
+    uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_RELAXED);
+    while (true)
+    {
+        KMsgRecord *record = record_at(tail);
+        uint8_t state = __atomic_load_n(&record->state, __ATOMIC_ACQUIRE);
+        uint32_t size = record->size;
+
+        if (state == KMSG_FREE)
+            break;
+
+        if (state == KMSG_COMMITTED)
+        {
+            // Prefix messages starting a new line with their timestamp and tag
+            if (line_start)
+            {
+                char prefix[64];
+                int n = kernel::snformat(prefix, sizeof(prefix), "[%5lu.%06lu] %s%s%s",
+                                 (unsigned long)(record->timestamp / NSEC_PER_SEC),
+                                 (unsigned long)(record->timestamp % NSEC_PER_SEC / 1000),
+                                 record->tag ? record->tag : "",
+                                 record->tag ? ": " : "",
+                                 record->level == LOG_LEVEL_ERROR  ? "error: "
+                                 : record->level == LOG_LEVEL_WARN ? "warning: "
+                                                                   : "");
+                emit(prefix, n < (int)sizeof(prefix) ? n : sizeof(prefix) - 1);
+            }
+            emit(record->text, record->len);
+            line_start = record->len > 0 && record->text[record->len - 1] == '\n';
+            count++;
+        }
+
+        // Release the consumed space back to producers
+        memset(record, 0, size);
+        tail += size;
+        __atomic_store_n(&ring.tail, tail, __ATOMIC_RELEASE);
+    }
+
+    uint32_t drops = __atomic_load_n(&ring.dropped, __ATOMIC_RELAXED);
+    if (drops != reported_drops)
+    {
+        char note[48];
+        int n = kernel::snformat(note, sizeof(note), "%s*** kmsg: %lu messages dropped\n",
+                         line_start ? "" : "\n", (unsigned long)(drops - reported_drops));
+        emit(note, n < (int)sizeof(note) ? n : sizeof(note) - 1);
+        reported_drops = drops;
+        line_start = true;
+    }
+
+    // Retry output held back by slow devices
+    kernel::tty_flush();
+
+    __atomic_store_n(&ring.draining, 0, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+uint32_t kernel::KMsg::dropped()
+{
+    return __atomic_load_n(&ring.dropped, __ATOMIC_RELAXED);
+}
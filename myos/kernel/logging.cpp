@@ -0,0 +1,56 @@
+#include <stdarg.h>
+#include <string.h>
+
+#include <kernel/kmsg.hpp>
+#include <kernel/logging.hpp>
+
+int kernel::Log::level = CONFIG_LOG_LEVEL;
+
+/**
+ * Log level names indexed by level
+ */
+static const char *level_names[] = {"debug", "info", "warn", "error", "none"};
+
+void kernel::Log::vlog(int level, const char *tag, const char *fmt, va_list args)
+{
+    kernel::KMsg::vlog(level, tag, fmt, args);
+}
+
+void kernel::Log::log(int level, const char *tag, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vlog(level, tag, fmt, ap);
+    va_end(ap);
+}
+
+void kernel::Log::parse_cmdline(const char *cmdline)
+{
+    const char *option = "loglevel=";
+    const size_t option_len = strlen(option);
+
+    for (const char *p = cmdline; (p = strstr(p, option)) != nullptr; p += option_len)
+    {
+        // Option must start a command line word
+        if (p != cmdline && p[-1] != ' ')
+            continue;
+
+        const char *value = p + option_len;
+        size_t value_len = strcspn(value, " ");
+
+        for (int i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_NONE; i++)
+        {
+            if (strlen(level_names[i]) == value_len && strncmp(value, level_names[i], value_len) == 0)
+            {
+                level = i;
+                return;
+            }
+        }
+        if (value_len == 1 && value[0] >= '0' + LOG_LEVEL_DEBUG && value[0] <= '0' + LOG_LEVEL_NONE)
+        {
+            level = value[0] - '0';
+            return;
+        }
+    }
+}
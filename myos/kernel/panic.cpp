@@ -3,6 +3,12 @@
 #include <kernel/ioport.hpp>
 #include <kernel/panic.hpp>
 #include <kernel/console.hpp>
+#include <kernel/kmsg.hpp>
+#include <kernel/format.hpp>
+#include <kernel/serial.hpp>
+#include <kernel/isr.hpp>
+#include <kernel/frame.hpp>
+#include <kernel/slab.hpp>
 
 /**
  * Sick PC logo
@@ -33,6 +39,9 @@ void kernel::panic(const char *__restrict fmt, ...)
     // Disable interrupts
     cli();
 
+    // Write out pending kernel messages
+    KMsg::drain();
+
     // Clear system console screen
     console.set_bg_color(VGA_COLOR_BLUE);
     console.set_fg_color(VGA_COLOR_WHITE);
@@ -48,6 +57,22 @@ void kernel::panic(const char *__restrict fmt, ...)
     console.vprintf(fmt, ap);
     va_end(ap);
 
+    // Report on serial line for headless systems
+    va_start(ap, fmt);
+    format(Serial::sink, &serial1, "\n*** STOP: ");
+    vformat(Serial::sink, &serial1, fmt, ap);
+    format(Serial::sink, &serial1, "\n");
+    va_end(ap);
+
+    // Report time spent in interrupt handlers and memory usage. The panic screen has no room left for it.
+    format(Serial::sink, &serial1, "\n");
+    IVT::dump_stats(Serial::sink, &serial1);
+    format(Serial::sink, &serial1, "\n");
+    PageFrame::dump_stats(Serial::sink, &serial1);
+    format(Serial::sink, &serial1, "\n");
+    kmem_cache_dump_stats(Serial::sink, &serial1);
+    serial1.sync();
+
     // Hang CPU
     /** TODO: Hang all CPUs */
     hang();
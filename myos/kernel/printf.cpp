@@ -1,23 +1,17 @@
 #include <stdarg.h>
 #include <stddef.h>
-#include <stdio.h>
 
-#include <kernel/tty.hpp>
+#include <kernel/kmsg.hpp>
+#include <kernel/logging.hpp>
 #include <kernel/printf.hpp>
 
-#define KPRINTF_BUFSIZ 64
-
 /*
- * Print to the first console.
+ * Log to the kernel message ring. The message is written to the
+ * console devices when the ring is drained.
  */
 void kernel::vprintf(const char *fmt, va_list args)
 {
-    char str[KPRINTF_BUFSIZ];
-    int n;
-
-    n = vsnprintf(str, KPRINTF_BUFSIZ, fmt, args);
-    if (n > 0)
-        kernel::tty.write(str, (size_t)n);
+    kernel::KMsg::vlog(LOG_LEVEL_INFO, nullptr, fmt, args);
 }
 
 void kernel::printf(const char *__restrict fmt, ...)
@@ -27,4 +21,4 @@ void kernel::printf(const char *__restrict fmt, ...)
     va_start(ap, fmt);
     vprintf(fmt, ap);
     va_end(ap);
-}
\ No newline at end of file
+}
@@ -0,0 +1,599 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <arch/cache.hpp>
+#include <arch/page.hpp>
+#include <kernel/frame.hpp>
+#include <kernel/ioport.hpp>
+#include <kernel/panic.hpp>
+#include <kernel/slab.hpp>
+
+//-----------------------------------------------
+//	Slab geometry
+//-----------------------------------------------
+
+#define SLAB_MAX_ORDER 3   // largest slab, 8 frames
+#define SLAB_MIN_OBJECTS 8 // objects fitting in the largest slab at least
+#define SLAB_WASTE_SHIFT 3 // slab size is raised until at most 1/8 is wasted
+#define SLAB_EMPTY_MAX 1   // empty slabs kept before releasing to the frame allocator
+
+/** Object pointers in a magazine, sized so a magazine is 64 bytes */
+#define MAGAZINE_SIZE 14
+
+/** Full magazines kept in a depot before objects go back to the slabs */
+#define DEPOT_FULL_MAX 8
+
+/** Round up to a power of two alignment */
+#define ALIGN_UP(x, align) (((x) + (align)-1) & ~((align)-1))
+
+/**
+ * Slab header, at the start of the slab. Free objects are linked through
+ * their first word.
+ */
+struct Slab
+{
+    Slab *next;               /**< Next slab in list */
+    Slab *prev;               /**< Previous slab in list */
+    kernel::KmemCache *cache; /**< Owning cache */
+    void *free;               /**< First free object */
+    size_t inuse;             /**< Objects allocated from the slab */
+};
+
+/**
+ * Magazine, a stack of free objects
+ */
+struct Magazine
+{
+    Magazine *next;               /**< Next magazine in depot list */
+    size_t rounds;                /**< Number of objects */
+    void *objects[MAGAZINE_SIZE]; /**< Objects, the last one is popped first */
+};
+
+/**
+ * CPU layer of a cache. The loaded magazine serves allocations and frees
+ * and the previous one, either full or empty, is swapped in when loaded
+ * runs empty or full.
+ *
+ * This is a uniprocessor kernel, so each cache has one CPU layer. It is
+ * only touched by the local CPU, so disabling local interrupts is all the
+ * locking it needs.
+ */
+struct CPUCache
+{
+    Magazine *loaded;   /**< Magazine in use */
+    Magazine *previous; /**< Full or empty magazine */
+};
+
+/**
+ * Depot of full and empty magazines shared by the CPU layers
+ */
+struct Depot
+{
+    Magazine *full;  /**< Full magazines */
+    Magazine *empty; /**< Empty magazines */
+    size_t nr_full;  /**< Number of full magazines */
+};
+
+struct kernel::KmemCache
+{
+    char name[KMEM_CACHE_NAME_MAX]; /**< Cache name */
+    size_t size;                    /**< Object size including padding */
+    size_t offset;                  /**< Offset of the first object in an uncolored slab */
+    uint32_t order;                 /**< Slab order */
+    size_t nr_objects;              /**< Objects in a slab */
+    size_t color_unit;              /**< Offset between slab colors */
+    size_t color_max;               /**< Last slab color */
+    size_t color_next;              /**< Color of the next slab */
+    bool magazines;                 /**< Objects are cached in magazines */
+    CPUCache cpu;                   /**< CPU layer */
+    Depot depot;                    /**< Magazine depot */
+    Slab *full;                     /**< Slabs with all objects allocated */
+    Slab *partial;                  /**< Slabs with free and allocated objects */
+    Slab *empty;                    /**< Slabs with all objects free */
+    size_t nr_empty;                /**< Number of empty slabs */
+    KmemCacheStats stats;           /**< Cache statistics */
+    KmemCache *next;                /**< Next cache in cache list */
+};
+
+/**
+ * Cache of cache descriptors
+ */
+static kernel::KmemCache cache_cache;
+
+/**
+ * Cache of magazines. Magazines are allocated while objects are freed, so
+ * the cache itself does not use magazines.
+ */
+static kernel::KmemCache magazine_cache;
+
+/**
+ * List of all caches
+ */
+static kernel::KmemCache *caches = nullptr;
+
+static void list_add(Slab **head, Slab *slab)
+{
+    slab->prev = nullptr;
+    slab->next = *head;
+    if (*head != nullptr)
+        (*head)->prev = slab;
+    *head = slab;
+}
+
+static void list_del(Slab **head, Slab *slab)
+{
+    if (slab->prev != nullptr)
+        slab->prev->next = slab->next;
+    else
+        *head = slab->next;
+    if (slab->next != nullptr)
+        slab->next->prev = slab->prev;
+    slab->next = nullptr;
+    slab->prev = nullptr;
+}
+
+static inline Magazine *magazine_pop(Magazine **head)
+{
+    Magazine *magazine = *head;
+    if (magazine != nullptr)
+        *head = magazine->next;
+    return magazine;
+}
+
+static inline void magazine_push(Magazine **head, Magazine *magazine)
+{
+    magazine->next = *head;
+    *head = magazine;
+}
+
+/**
+ * Get the slab holding an object. Slabs are aligned on their size.
+ *
+ * @param cache pointer to cache
+ * @param object pointer to object
+ * @returns pointer to slab header
+ */
+static inline Slab *slab_of(kernel::KmemCache *cache, void *object)
+{
+    return (Slab *)((uintptr_t)object & ~((PAGE_SIZE << cache->order) - 1));
+}
+
+/**
+ * Set up a cache descriptor
+ *
+ * @param cache pointer to cache
+ * @param name cache name
+ * @param size object size in bytes
+ * @param align object alignment
+ * @param magazines true to cache objects in magazines
+ * @returns 0 on success and -1 on invalid size or alignment
+ */
+static int setup_cache(kernel::KmemCache *cache, const char *name, size_t size, size_t align, bool magazines)
+{
+    size_t bytes = 0;
+    size_t waste = 0;
+
+    if (align == 0 || align < sizeof(void *))
+        align = sizeof(void *);
+    if (align & (align - 1))
+        return -1;
+
+    // Free objects hold the free list link
+    if (size < sizeof(void *))
+        size = sizeof(void *);
+    size = ALIGN_UP(size, align);
+    if (size > (PAGE_SIZE << SLAB_MAX_ORDER) / SLAB_MIN_OBJECTS)
+        return -1;
+
+    memset(cache, 0, sizeof(*cache));
+    strncpy(cache->name, name, KMEM_CACHE_NAME_MAX - 1);
+    cache->size = size;
+    cache->offset = ALIGN_UP(sizeof(Slab), align);
+    cache->magazines = magazines;
+
+    // Pick the smallest slab wasting little space
+    for (cache->order = 0; cache->order <= SLAB_MAX_ORDER; cache->order++)
+    {
+        bytes = PAGE_SIZE << cache->order;
+        cache->nr_objects = (bytes - cache->offset) / size;
+        waste = bytes - cache->offset - cache->nr_objects * size;
+        if (cache->nr_objects && (waste << SLAB_WASTE_SHIFT) <= bytes)
+            break;
+        if (cache->order == SLAB_MAX_ORDER)
+            break;
+    }
+
+    // Spread the first objects of successive slabs over the wasted space
+    cache->color_unit = align > L1_CACHE_BYTES ? align : L1_CACHE_BYTES;
+    cache->color_max = waste / cache->color_unit;
+
+    cache->stats.object_size = size;
+    cache->stats.slab_size = bytes;
+    cache->stats.objects_per_slab = cache->nr_objects;
+    return 0;
+}
+
+/**
+ * Add an empty slab to a cache. Must be called with interrupts disabled.
+ *
+ * @param cache pointer to cache
+ * @returns pointer to slab or nullptr if out of memory
+ */
+static Slab *grow(kernel::KmemCache *cache)
+{
+    uintptr_t addr = cache->order ? kernel::PageFrame::alloc_pages(cache->order) : kernel::PageFrame::alloc();
+    if (addr == 0)
+        return nullptr;
+
+    Slab *slab = (Slab *)phys_to_virt(addr);
+    slab->cache = cache;
+    slab->inuse = 0;
+
+    size_t color = cache->color_next * cache->color_unit;
+    cache->color_next = cache->color_next == cache->color_max ? 0 : cache->color_next + 1;
+
+    // Link the free objects in address order
+    uint8_t *object = (uint8_t *)slab + cache->offset + color;
+    slab->free = object;
+    for (size_t i = 1; i < cache->nr_objects; i++, object += cache->size)
+        *(void **)object = object + cache->size;
+    *(void **)object = nullptr;
+
+    list_add(&cache->empty, slab);
+    cache->nr_empty++;
+    cache->stats.nr_slabs++;
+    cache->stats.grows++;
+    return slab;
+}
+
+/**
+ * Release an empty slab to the frame allocator. Must be called with
+ * interrupts disabled.
+ *
+ * @param cache pointer to cache
+ * @param slab pointer to empty slab
+ */
+static void reap(kernel::KmemCache *cache, Slab *slab)
+{
+    list_del(&cache->empty, slab);
+    cache->nr_empty--;
+    cache->stats.nr_slabs--;
+    cache->stats.reaps++;
+
+    if (cache->order)
+        kernel::PageFrame::free_pages(virt_to_phys(slab), cache->order);
+    else
+        kernel::PageFrame::free(virt_to_phys(slab));
+}
+
+/**
+ * Allocate an object from the slab lists. Must be called with interrupts
+ * disabled.
+ *
+ * @param cache pointer to cache
+ * @returns pointer to object or nullptr if out of memory
+ */
+static void *slab_alloc(kernel::KmemCache *cache)
+{
+    Slab *slab = cache->partial;
+
+    if (slab == nullptr)
+    {
+        slab = cache->empty ? cache->empty : grow(cache);
+        if (slab == nullptr)
+            return nullptr;
+
+        list_del(&cache->empty, slab);
+        cache->nr_empty--;
+        list_add(&cache->partial, slab);
+    }
+
+    void *object = slab->free;
+    slab->free = *(void **)object;
+    slab->inuse++;
+
+    if (slab->inuse == cache->nr_objects)
+    {
+        list_del(&cache->partial, slab);
+        list_add(&cache->full, slab);
+    }
+
+    return object;
+}
+
+/**
+ * Return an object to its slab. Must be called with interrupts disabled.
+ *
+ * @param cache pointer to cache
+ * @param object pointer to object
+ */
+static void slab_free(kernel::KmemCache *cache, void *object)
+{
+    Slab *slab = slab_of(cache, object);
+
+    if (slab->cache != cache)
+        kernel::panic("kmem_cache_free: object %p not from cache %s", object, cache->name);
+
+    Slab **list = slab->inuse == cache->nr_objects ? &cache->full : &cache->partial;
+
+    *(void **)object = slab->free;
+    slab->free = object;
+    slab->inuse--;
+
+    if (slab->inuse == 0)
+    {
+        list_del(list, slab);
+        list_add(&cache->empty, slab);
+        cache->nr_empty++;
+
+        if (cache->nr_empty > SLAB_EMPTY_MAX)
+            reap(cache, slab);
+    }
+    else if (list == &cache->full)
+    {
+        list_del(&cache->full, slab);
+        list_add(&cache->partial, slab);
+    }
+}
+
+/**
+ * Return the objects of a magazine to their slabs. Must be called with
+ * interrupts disabled.
+ *
+ * @param cache pointer to cache
+ * @param magazine pointer to magazine
+ */
+static void drain_magazine(kernel::KmemCache *cache, Magazine *magazine)
+{
+    while (magazine->rounds)
+    {
+        slab_free(cache, magazine->objects[--magazine->rounds]);
+        cache->stats.nr_cached--;
+    }
+}
+
+/**
+ * Return the objects of a magazine to their slabs and free the magazine.
+ * Must be called with interrupts disabled.
+ *
+ * @param cache pointer to cache
+ * @param magazine pointer to magazine or nullptr
+ */
+static void flush_magazine(kernel::KmemCache *cache, Magazine *magazine)
+{
+    if (magazine == nullptr)
+        return;
+
+    drain_magazine(cache, magazine);
+    kernel::kmem_cache_free(&magazine_cache, magazine);
+}
+
+void kernel::kmem_cache_init()
+{
+    setup_cache(&cache_cache, "kmem_cache", sizeof(kernel::KmemCache), 0, false);
+    setup_cache(&magazine_cache, "magazine", sizeof(Magazine), 0, false);
+
+    magazine_cache.next = caches;
+    cache_cache.next = &magazine_cache;
+    caches = &cache_cache;
+}
+
+kernel::KmemCache *kernel::kmem_cache_create(const char *name, size_t size, size_t align)
+{
+    kernel::KmemCache *cache = (kernel::KmemCache *)kmem_cache_alloc(&cache_cache);
+    if (cache == nullptr)
+        return nullptr;
+
+    if (setup_cache(cache, name, size, align, true))
+    {
+        kmem_cache_free(&cache_cache, cache);
+        return nullptr;
+    }
+
+    unsigned long flags = kernel::irq_save();
+    cache->next = caches;
+    caches = cache;
+    kernel::irq_restore(flags);
+
+    return cache;
+}
+
+int kernel::kmem_cache_destroy(kernel::KmemCache *cache)
+{
+    kmem_cache_shrink(cache);
+
+    unsigned long flags = kernel::irq_save();
+
+    if (cache->stats.nr_active || cache->partial != nullptr || cache->full != nullptr)
+    {
+        kernel::irq_restore(flags);
+        return -1;
+    }
+
+    kernel::KmemCache **link = &caches;
+    while (*link != cache)
+        link = &(*link)->next;
+    *link = cache->next;
+
+    kernel::irq_restore(flags);
+
+    kmem_cache_free(&cache_cache, cache);
+    return 0;
+}
+
+void *kernel::kmem_cache_alloc(kernel::KmemCache *cache)
+{
+    void *object = nullptr;
+
+    unsigned long flags = kernel::irq_save();
+
+    if (cache->magazines)
+    {
+        CPUCache *cpu = &cache->cpu;
+
+        if (cpu->loaded == nullptr || cpu->loaded->rounds == 0)
+        {
+            if (cpu->previous != nullptr && cpu->previous->rounds)
+            {
+                Magazine *full = cpu->previous;
+                cpu->previous = cpu->loaded;
+                cpu->loaded = full;
+            }
+            else if (cache->depot.full != nullptr)
+            {
+                // Trade the empty previous magazine for a full one
+                if (cpu->previous != nullptr)
+                    magazine_push(&cache->depot.empty, cpu->previous);
+                cpu->previous = cpu->loaded;
+                cpu->loaded = magazine_pop(&cache->depot.full);
+                cache->depot.nr_full--;
+            }
+        }
+
+        if (cpu->loaded != nullptr && cpu->loaded->rounds)
+        {
+            object = cpu->loaded->objects[--cpu->loaded->rounds];
+            cache->stats.nr_cached--;
+            cache->stats.magazine_hits++;
+        }
+    }
+
+    if (object == nullptr)
+        object = slab_alloc(cache);
+
+    if (object != nullptr)
+    {
+        cache->stats.allocs++;
+        cache->stats.nr_active++;
+    }
+    else
+    {
+        cache->stats.failures++;
+    }
+
+    kernel::irq_restore(flags);
+    return object;
+}
+
+void kernel::kmem_cache_free(kernel::KmemCache *cache, void *object)
+{
+    unsigned long flags = kernel::irq_save();
+
+    cache->stats.frees++;
+    cache->stats.nr_active--;
+
+    if (cache->magazines)
+    {
+        CPUCache *cpu = &cache->cpu;
+
+        if (cpu->loaded == nullptr || cpu->loaded->rounds == MAGAZINE_SIZE)
+        {
+            if (cpu->previous != nullptr && cpu->previous->rounds == 0)
+            {
+                Magazine *empty = cpu->previous;
+                cpu->previous = cpu->loaded;
+                cpu->loaded = empty;
+            }
+            else
+            {
+                Magazine *empty = nullptr;
+
+                if (cpu->previous != nullptr && cache->depot.nr_full >= DEPOT_FULL_MAX)
+                {
+                    // Depot is full, empty the previous magazine into the slabs
+                    empty = cpu->previous;
+                    drain_magazine(cache, empty);
+                }
+                else
+                {
+                    // Trade the full previous magazine for an empty one
+                    empty = magazine_pop(&cache->depot.empty);
+                    if (empty == nullptr)
+                    {
+                        empty = (Magazine *)kmem_cache_alloc(&magazine_cache);
+                        if (empty != nullptr)
+                            empty->rounds = 0;
+                    }
+
+                    if (empty != nullptr && cpu->previous != nullptr)
+                    {
+                        magazine_push(&cache->depot.full, cpu->previous);
+                        cache->depot.nr_full++;
+                    }
+                }
+
+                if (empty != nullptr)
+                {
+                    cpu->previous = cpu->loaded;
+                    cpu->loaded = empty;
+                }
+            }
+        }
+
+        if (cpu->loaded != nullptr && cpu->loaded->rounds < MAGAZINE_SIZE)
+        {
+            cpu->loaded->objects[cpu->loaded->rounds++] = object;
+            cache->stats.nr_cached++;
+            kernel::irq_restore(flags);
+            return;
+        }
+    }
+
+    // No magazine to hold the object
+    slab_free(cache, object);
+
+    kernel::irq_restore(flags);
+}
+
+size_t kernel::kmem_cache_shrink(kernel::KmemCache *cache)
+{
+    unsigned long flags = kernel::irq_save();
+    uint32_t reaps = cache->stats.reaps;
+
+    flush_magazine(cache, cache->cpu.loaded);
+    flush_magazine(cache, cache->cpu.previous);
+    cache->cpu.loaded = nullptr;
+    cache->cpu.previous = nullptr;
+
+    while (cache->depot.full != nullptr)
+        flush_magazine(cache, magazine_pop(&cache->depot.full));
+    cache->depot.nr_full = 0;
+    while (cache->depot.empty != nullptr)
+        flush_magazine(cache, magazine_pop(&cache->depot.empty));
+
+    while (cache->empty != nullptr)
+        reap(cache, cache->empty);
+
+    size_t released = (size_t)(cache->stats.reaps - reaps) << cache->order;
+
+    kernel::irq_restore(flags);
+    return released;
+}
+
+void kernel::kmem_cache_get_stats(kernel::KmemCache *cache, kernel::KmemCacheStats *stats)
+{
+    unsigned long flags = kernel::irq_save();
+    *stats = cache->stats;
+    kernel::irq_restore(flags);
+}
+
+void kernel::kmem_cache_dump_stats(kernel::format_sink_t sink, void *ctx)
+{
+    format(sink, ctx, "cache              active   cached    total  size objs pages  slabs     hits fails\n");
+
+    unsigned long flags = kernel::irq_save();
+
+    for (kernel::KmemCache *cache = caches; cache != nullptr; cache = cache->next)
+    {
+        kernel::KmemCacheStats *s = &cache->stats;
+
+        format(sink, ctx, "%-16s %8lu %8lu %8lu %5lu %4lu %5lu %6lu %8lu %5lu\n", cache->name,
+               (unsigned long)s->nr_active, (unsigned long)s->nr_cached,
+               (unsigned long)(s->nr_slabs * s->objects_per_slab), (unsigned long)s->object_size,
+               (unsigned long)s->objects_per_slab, (unsigned long)(s->slab_size / PAGE_SIZE),
+               (unsigned long)s->nr_slabs, (unsigned long)s->magazine_hits, (unsigned long)s->failures);
+    }
+
+    kernel::irq_restore(flags);
+}
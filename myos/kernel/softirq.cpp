@@ -0,0 +1,123 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/softirq.hpp>
+
+/**
+ * Registered softirq handlers
+ */
+static kernel::softirq_handler_t handlers[NR_SOFTIRQS];
+
+/**
+ * Bit mask of pending softirqs
+ */
+static volatile uint32_t pending_mask = 0;
+
+/**
+ * Set while softirqs run. Interrupts nested in a softirq handler must not
+ * run softirqs again on their exit.
+ */
+static bool running = false;
+
+/**
+ * List of scheduled tasklets in scheduling order
+ */
+static kernel::Tasklet *tasklet_head = nullptr;
+static kernel::Tasklet **tasklet_tail = &tasklet_head;
+
+/**
+ * Softirq handler running scheduled tasklets
+ */
+static void tasklet_action()
+{
+    unsigned long flags = kernel::irq_save();
+
+    kernel::Tasklet *list = tasklet_head;
+    tasklet_head = nullptr;
+    tasklet_tail = &tasklet_head;
+
+    kernel::irq_restore(flags);
+
+    while (list != nullptr)
+    {
+        kernel::Tasklet *tasklet = list;
+        list = list->next;
+
+        // Allow the tasklet to schedule itself again while it runs
+        flags = kernel::irq_save();
+        tasklet->next = nullptr;
+        tasklet->scheduled = false;
+        kernel::irq_restore(flags);
+
+        tasklet->func(tasklet->data);
+    }
+}
+
+void kernel::SoftIRQ::open(uint32_t n, kernel::softirq_handler_t handler)
+{
+    if (n == SOFTIRQ_TASKLET)
+        return;
+    if (n < NR_SOFTIRQS)
+        handlers[n] = handler;
+}
+
+void kernel::SoftIRQ::raise(uint32_t n)
+{
+    if (n < NR_SOFTIRQS)
+        __atomic_fetch_or(&pending_mask, 1u << n, __ATOMIC_RELAXED);
+}
+
+void kernel::SoftIRQ::run()
+{
+    unsigned long flags = kernel::irq_save();
+
+    if (running || pending_mask == 0)
+    {
+        kernel::irq_restore(flags);
+        return;
+    }
+    running = true;
+
+    for (size_t restart = 0; pending_mask && restart < SOFTIRQ_MAX_RESTART; restart++)
+    {
+        uint32_t mask = pending_mask;
+        pending_mask = 0;
+
+        kernel::sti();
+        for (uint32_t n = 0; mask; n++, mask >>= 1)
+        {
+            if (!(mask & 1))
+                continue;
+            if (n == SOFTIRQ_TASKLET)
+                tasklet_action();
+            else if (handlers[n] != nullptr)
+                handlers[n]();
+        }
+        kernel::cli();
+    }
+
+    running = false;
+    kernel::irq_restore(flags);
+}
+
+bool kernel::SoftIRQ::pending()
+{
+    return pending_mask != 0;
+}
+
+void kernel::Tasklet::schedule()
+{
+    unsigned long flags = kernel::irq_save();
+
+    if (!scheduled)
+    {
+        scheduled = true;
+        next = nullptr;
+        *tasklet_tail = this;
+        tasklet_tail = &next;
+        kernel::SoftIRQ::raise(SOFTIRQ_TASKLET);
+    }
+
+    kernel::irq_restore(flags);
+}
@@ -0,0 +1,81 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/times.h>
+
+#include <kernel/syscall.hpp>
+#include <kernel/time.hpp>
+
+/**
+ * System call function pointer typedef
+ */
+typedef long (*syscall_func_t)(uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+/**
+ * Get process times. There are no processes yet, so all time since boot
+ * is accounted as system time.
+ *
+ * @param arg1 pointer to struct tms to fill or null
+ * @returns system clock ticks since boot
+ */
+static long sys_times(uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+    struct tms *buf = (struct tms *)arg1;
+    clock_t ticks = kernel::get_ticks64();
+
+    if (buf != nullptr)
+    {
+        buf->tms_utime = 0;
+        buf->tms_stime = ticks;
+        buf->tms_cutime = 0;
+        buf->tms_cstime = 0;
+    }
+    return ticks;
+}
+
+/**
+ * Get wall clock time.
+ *
+ * @param arg1 pointer to struct timeval to fill or null
+ * @param arg2 pointer to struct timezone to fill or null
+ * @returns 0
+ */
+static long sys_gettimeofday(uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+    struct timeval *tv = (struct timeval *)arg1;
+    struct timezone *tz = (struct timezone *)arg2;
+
+    if (tv != nullptr)
+    {
+        uint64_t ns = kernel::ktime_get_real_ns();
+        tv->tv_sec = ns / NSEC_PER_SEC;
+        tv->tv_usec = ns % NSEC_PER_SEC / 1000;
+    }
+
+    // The wall clock runs in UTC
+    if (tz != nullptr)
+    {
+        tz->tz_minuteswest = 0;
+        tz->tz_dsttime = 0;
+    }
+    return 0;
+}
+
+/**
+ * System call table indexed by system call number
+ */
+static const syscall_func_t syscalls[] = {
+    [0] = nullptr,
+    [SYS_times] = sys_times,
+    [SYS_gettimeofday] = sys_gettimeofday,
+};
+
+long kernel::syscall(uint32_t n, uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+    if (n >= sizeof(syscalls) / sizeof(syscalls[0]) || syscalls[n] == nullptr)
+        return -ENOSYS;
+
+    return syscalls[n](arg1, arg2, arg3);
+}
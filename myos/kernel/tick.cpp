@@ -0,0 +1,34 @@
+#include <stdint.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/time.hpp>
+#include <kernel/timer.hpp>
+
+void kernel::Tick::idle()
+{
+    kernel::cli();
+
+    // Deferred work left over by interrupt exits runs first
+    if (kernel::SoftIRQ::pending())
+    {
+        kernel::sti();
+        return;
+    }
+
+    /**
+     * The deadline is read with interrupts disabled, so a timer armed by
+     * an interrupt exit in the meantime can not be missed.
+     */
+    int32_t delta = (int32_t)(kernel::next_timer_event() - kernel::get_ticks());
+
+    // Deadlines due within a tick are served by the periodic tick
+    if (delta > 1)
+        kernel::tick_stop(delta);
+
+    kernel::halt();
+
+    kernel::cli();
+    kernel::tick_restart();
+    kernel::sti();
+}
@@ -0,0 +1,266 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <kernel/ioport.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/time.hpp>
+#include <kernel/timer.hpp>
+
+//-----------------------------------------------
+//	Timing wheel geometry
+//-----------------------------------------------
+
+#define TVR_BITS 8 // first level slot index bits
+#define TVN_BITS 6 // outer level slot index bits
+#define TVR_SIZE (1 << TVR_BITS)
+#define TVN_SIZE (1 << TVN_BITS)
+#define TVR_MASK (TVR_SIZE - 1)
+#define TVN_MASK (TVN_SIZE - 1)
+
+/** Number of outer levels */
+#define TVN_LEVELS 4
+
+/**
+ * Slot index of a tick count in an outer level
+ */
+#define TVN_INDEX(ticks, level) (((ticks) >> (TVR_BITS + (level)*TVN_BITS)) & TVN_MASK)
+
+/**
+ * First level slots, one per tick
+ */
+static kernel::Timer *tv1[TVR_SIZE];
+
+/**
+ * Outer level slots, each covering 64 times the span of the level below
+ */
+static kernel::Timer *tvn[TVN_LEVELS][TVN_SIZE];
+
+/**
+ * Tick count of the next first level slot to run
+ */
+static uint32_t timer_ticks = 0;
+
+/**
+ * Link timer at the head of a slot list
+ *
+ * @param head pointer to slot list head
+ * @param timer pointer to timer
+ */
+static void link_timer(kernel::Timer **head, kernel::Timer *timer)
+{
+    timer->next = *head;
+    if (timer->next != nullptr)
+        timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
+
+/**
+ * Unlink timer from its slot list
+ *
+ * @param timer pointer to pending timer
+ */
+static void unlink_timer(kernel::Timer *timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != nullptr)
+        timer->next->pprev = timer->pprev;
+    timer->next = nullptr;
+    timer->pprev = nullptr;
+}
+
+/**
+ * Insert timer into the wheel slot matching its expiry time. Must be
+ * called with interrupts disabled.
+ *
+ * @param timer pointer to timer
+ */
+static void internal_add_timer(kernel::Timer *timer)
+{
+    uint32_t expires = timer->expires;
+    uint32_t delta = expires - timer_ticks;
+    kernel::Timer **head;
+
+    if ((int32_t)delta < 0)
+    {
+        // Already expired, run from the next slot
+        head = &tv1[timer_ticks & TVR_MASK];
+    }
+    else if (delta < TVR_SIZE)
+    {
+        head = &tv1[expires & TVR_MASK];
+    }
+    else
+    {
+        size_t level = 0;
+        while (level < TVN_LEVELS - 1 && delta >= (1u << (TVR_BITS + (level + 1) * TVN_BITS)))
+            level++;
+        head = &tvn[level][TVN_INDEX(expires, level)];
+    }
+
+    link_timer(head, timer);
+}
+
+/**
+ * Move the timers of an outer level slot down the wheel. Must be called
+ * with interrupts disabled.
+ *
+ * @param level outer level
+ * @param index slot index
+ * @returns slot index
+ */
+static size_t cascade(size_t level, size_t index)
+{
+    kernel::Timer *list = tvn[level][index];
+    tvn[level][index] = nullptr;
+
+    while (list != nullptr)
+    {
+        kernel::Timer *timer = list;
+        list = list->next;
+        internal_add_timer(timer);
+    }
+
+    return index;
+}
+
+/**
+ * Timer softirq handler running expired timers
+ */
+static void run_timers()
+{
+    unsigned long flags = kernel::irq_save();
+
+    while (time_after_eq(kernel::get_ticks(), timer_ticks))
+    {
+        size_t index = timer_ticks & TVR_MASK;
+
+        // Refill the first level from the outer ones once per lap
+        if (index == 0)
+        {
+            for (size_t level = 0; level < TVN_LEVELS; level++)
+            {
+                if (cascade(level, TVN_INDEX(timer_ticks, level)) != 0)
+                    break;
+            }
+        }
+        timer_ticks++;
+
+        // Detach the slot so timers added by timer functions do not run now
+        kernel::Timer *work_list = nullptr;
+        if (tv1[index] != nullptr)
+        {
+            work_list = tv1[index];
+            work_list->pprev = &work_list;
+            tv1[index] = nullptr;
+        }
+
+        while (work_list != nullptr)
+        {
+            kernel::Timer *timer = work_list;
+            unlink_timer(timer);
+
+            kernel::irq_restore(flags);
+            timer->func(timer->data);
+            flags = kernel::irq_save();
+        }
+    }
+
+    kernel::irq_restore(flags);
+}
+
+void kernel::timer_init()
+{
+    timer_ticks = kernel::get_ticks();
+    kernel::SoftIRQ::open(SOFTIRQ_TIMER, run_timers);
+}
+
+void kernel::add_timer(kernel::Timer *timer)
+{
+    kernel::mod_timer(timer, timer->expires);
+}
+
+int kernel::mod_timer(kernel::Timer *timer, uint32_t expires)
+{
+    unsigned long flags = kernel::irq_save();
+    int ret = 0;
+
+    if (timer->pending())
+    {
+        unlink_timer(timer);
+        ret = 1;
+    }
+    timer->expires = expires;
+    internal_add_timer(timer);
+
+    kernel::irq_restore(flags);
+    return ret;
+}
+
+int kernel::del_timer(kernel::Timer *timer)
+{
+    unsigned long flags = kernel::irq_save();
+    int ret = 0;
+
+    if (timer->pending())
+    {
+        unlink_timer(timer);
+        ret = 1;
+    }
+
+    kernel::irq_restore(flags);
+    return ret;
+}
+
+uint32_t kernel::next_timer_event()
+{
+    unsigned long flags = kernel::irq_save();
+    size_t index = timer_ticks & TVR_MASK;
+    uint32_t next = timer_ticks + (TVR_SIZE - index);
+
+    // First level timers expire at the tick of their slot
+    for (size_t i = 0; i < TVR_SIZE - index; i++)
+    {
+        if (tv1[index + i] != nullptr)
+        {
+            next = timer_ticks + i;
+            break;
+        }
+    }
+
+    kernel::irq_restore(flags);
+    return next;
+}
+
+/**
+ * Timer function ending a sleep
+ *
+ * @param data pointer to sleep completion flag
+ */
+static void wakeup(unsigned long data)
+{
+    *(volatile bool *)data = true;
+}
+
+void kernel::msleep(uint32_t ms)
+{
+    volatile bool done = false;
+    kernel::Timer timer(wakeup, (unsigned long)&done);
+
+    // Round up so partial ticks count as a full one
+    uint32_t delta = ((uint64_t)ms * CLOCKS_PER_SEC + 999) / 1000;
+    kernel::mod_timer(&timer, kernel::get_ticks() + delta + 1);
+
+    while (true)
+    {
+        kernel::SoftIRQ::run();
+
+        // An expiry between the check and the halt would be missed otherwise
+        kernel::cli();
+        if (done)
+            break;
+        kernel::Tick::idle();
+    }
+    kernel::sti();
+}
@@ -0,0 +1,15 @@
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+/*
+ * System call numbers. The number is passed in eax and the arguments in
+ * ebx, ecx and edx to the int 0x80 trap. The result is returned in eax,
+ * with values -4095 to -1 holding a negated errno.
+ */
+#define SYS_times 1        /**< Process times */
+#define SYS_gettimeofday 2 /**< Wall clock time */
+
+/** Largest errno returned by system calls */
+#define SYSCALL_MAX_ERRNO 4095
+
+#endif /* SYSCALL_H */
@@ -33,6 +33,12 @@
 #define IXON 0x0200   /**< Enable start/stop output control */
 #define PARMRK 0x0400 /**< Mark parity errors */
 
+/*
+ * Output flags, for 'c_oflag' inside the termios structure.
+ */
+#define OPOST 0x0001 /**< Enable output processing */
+#define ONLCR 0x0002 /**< Map NL to CR-NL on output */
+
 /*
  * Local flags, for 'c_lflag' inside the termios structure.
  */
@@ -4,6 +4,7 @@
 #include <sys/times.h>
 #include <sys/errno.h>
 #include <sys/time.h>
+#include <sys/syscall.h>
 #include <stdio.h>
 
 #ifdef __is_libc
@@ -27,6 +28,35 @@ clock_t times(struct tms *buf);
 int unlink(char *name);
 int wait(int *status);
 int write(int file, char *ptr, int len);
-int gettimeofday(struct timeval *p, struct timezone *z);
+int gettimeofday(struct timeval *__restrict p, void *__restrict z);
+
+/*
+ * Trap into the kernel with a system call. Negated errno results set
+ * errno and return -1.
+ */
+static long syscall3(long n, long arg1, long arg2, long arg3)
+{
+    long ret;
+    asm volatile("int $0x80"
+                 : "=a"(ret)
+                 : "a"(n), "b"(arg1), "c"(arg2), "d"(arg3)
+                 : "memory");
+    if ((unsigned long)ret >= (unsigned long)-SYSCALL_MAX_ERRNO)
+    {
+        errno = -ret;
+        return -1;
+    }
+    return ret;
+}
+
+clock_t times(struct tms *buf)
+{
+    return syscall3(SYS_times, (long)buf, 0, 0);
+}
+
+int gettimeofday(struct timeval *__restrict p, void *__restrict z)
+{
+    return syscall3(SYS_gettimeofday, (long)p, (long)z, 0);
+}
 
 #endif
\ No newline at end of file